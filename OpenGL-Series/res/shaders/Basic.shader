@@ -13,7 +13,10 @@ void main() {
 
 layout(location = 0) out vec4 color;
 
-uniform vec4 u_Color;
+// Set through a UniformBuffer, see MaterialUniforms in Application.cpp
+layout(std140) uniform Material {
+	vec4 u_Color;
+};
 
 void main() {
 	color = u_Color;
@@ -0,0 +1,54 @@
+#shader vertex
+#version 330 core
+		
+layout(location = 0) in vec2 a_Position;
+layout(location = 1) in vec4 a_Color;
+layout(location = 2) in vec2 a_TexCoord;
+layout(location = 3) in float a_TexIndex;
+
+out vec4 v_Color;
+out vec2 v_TexCoord;
+flat out float v_TexIndex;
+
+void main() {
+	gl_Position = vec4(a_Position, 0.0, 1.0);
+	v_Color = a_Color;
+	v_TexCoord = a_TexCoord;
+	v_TexIndex = a_TexIndex;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+in vec2 v_TexCoord;
+flat in float v_TexIndex;
+
+uniform sampler2D u_Textures[16];
+
+void main() {
+	// GLSL 330 only allows constant indices into sampler arrays, so the slot is picked with a switch instead of u_Textures[int(v_TexIndex)].
+	vec4 texColor;
+	switch (int(v_TexIndex)) {
+		case  0: texColor = texture(u_Textures[ 0], v_TexCoord); break;
+		case  1: texColor = texture(u_Textures[ 1], v_TexCoord); break;
+		case  2: texColor = texture(u_Textures[ 2], v_TexCoord); break;
+		case  3: texColor = texture(u_Textures[ 3], v_TexCoord); break;
+		case  4: texColor = texture(u_Textures[ 4], v_TexCoord); break;
+		case  5: texColor = texture(u_Textures[ 5], v_TexCoord); break;
+		case  6: texColor = texture(u_Textures[ 6], v_TexCoord); break;
+		case  7: texColor = texture(u_Textures[ 7], v_TexCoord); break;
+		case  8: texColor = texture(u_Textures[ 8], v_TexCoord); break;
+		case  9: texColor = texture(u_Textures[ 9], v_TexCoord); break;
+		case 10: texColor = texture(u_Textures[10], v_TexCoord); break;
+		case 11: texColor = texture(u_Textures[11], v_TexCoord); break;
+		case 12: texColor = texture(u_Textures[12], v_TexCoord); break;
+		case 13: texColor = texture(u_Textures[13], v_TexCoord); break;
+		case 14: texColor = texture(u_Textures[14], v_TexCoord); break;
+		case 15: texColor = texture(u_Textures[15], v_TexCoord); break;
+	}
+	color = texColor * v_Color;
+}
\ No newline at end of file
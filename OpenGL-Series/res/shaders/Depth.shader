@@ -0,0 +1,17 @@
+#shader vertex
+#version 330 core
+
+// Position-only input for depth and shadow passes, pairs with MultiStreamMesh::GetPositionVertexArray().
+layout(location = 0) in vec4 position;
+
+void main() {
+	gl_Position = position;
+}
+
+
+#shader fragment
+#version 330 core
+
+// No colour output, only the depth is written.
+void main() {
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#shader vertex
+#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 a_Offset; // per instance
+layout(location = 2) in vec4 a_Color;  // per instance
+
+uniform float u_Scale;
+
+out vec4 v_Color;
+
+void main() {
+	gl_Position = vec4(position.xy * u_Scale + a_Offset, 0.0, 1.0);
+	v_Color = a_Color;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main() {
+	color = v_Color;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#shader vertex
+#version 330 core
+
+// Instanced.shader with the per-instance offset and colour turned into per-draw values, so a loop of single draws covers the same pixels as one
+// instanced draw. Used by BenchmarkInstancing().
+layout(location = 0) in vec4 position;
+
+#ifdef PER_DRAW_BLOCK
+// Written per draw into the renderer's UniformRing, see Renderer::SubmitWithUniforms().
+layout(std140) uniform Draw {
+	vec4 u_Color;
+	vec2 u_Offset;
+	float u_Scale;
+};
+#else
+// Plain uniforms, set with SetUniform*() between draws.
+uniform vec4 u_Color;
+uniform vec2 u_Offset;
+uniform float u_Scale;
+#endif
+
+out vec4 v_Color;
+
+void main() {
+	gl_Position = vec4(position.xy * u_Scale + u_Offset, 0.0, 1.0);
+	v_Color = u_Color;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main() {
+	color = v_Color;
+}
\ No newline at end of file
@@ -13,9 +13,26 @@
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
-
-
-int main()
+#include "ResourcePool.h"
+#include "DeletionQueue.h"
+#include "DirectStateAccess.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderPermutationCache.h"
+#include "VertexFormatCache.h"
+#include "UniformBuffer.h"
+#include "Std140.h"
+#include "Benchmark.h"
+
+
+// C++ side of the 'Material' uniform block in Basic.shader.
+struct MaterialUniforms {
+
+	Std140::vec4 Color;
+};
+STD140_FIRST(MaterialUniforms, Color);
+STD140_END(MaterialUniforms);
+
+int main(int argc, char** argv)
 {
 	GLFWwindow* window;
 
@@ -27,6 +44,9 @@ int main()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // These 2 line sets OpenGL version to 3.3.		|| Major version - 3.0 || Minor version - 0.3 || 
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // alternative, for compatibilty profile instead -- GLFW_OPENGL_COMPAT_PROFILE 
+#if GL_CALL_CHECKS
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE); // most drivers only send glDebugMessageCallback messages to debug contexts
+#endif
 
 	/* Create a windowed mode window and its OpenGL context */
 	window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
@@ -41,12 +61,42 @@ int main()
 
 	glfwSwapInterval(1); // turns on Vsync
 
+	glewExperimental = GL_TRUE; // without this GLEW doesn't load the entry points of extensions (e.g. KHR_debug) on core profile contexts
 	if (glewInit() != GLEW_OK)
 		std::cout << "GLEW Error!" << std::endl;
 
+	// Errors get reported by the driver instead of polling glGetError() around every GLCall(), synchronously so errors are tied to the exact call. Release 
+	// builds (GL_CALL_CHECKS=0) skip it, the context has no debug flag and there is no checking overhead at all.
+#if GL_CALL_CHECKS
+	GLDebug::Init(true);
+#endif
+
 	// Prints in console showcasing OpenGL version, 4.6.0 in this case for my ROG G16
 	std::cout << (const char*)glGetString(GL_VERSION) << std::endl;
 
+	// GL 4.5 edits buffers, VAOs and uniforms without binding them, "--no-dsa" keeps the bind-to-edit path to compare against.
+	bool allowDirectStateAccess = true;
+	for (int i = 1; i < argc; i++)
+		if (std::string(argv[i]) == "--no-dsa")
+			allowDirectStateAccess = false;
+	DirectStateAccess::Init(allowDirectStateAccess);
+
+	// Linked programs are kept on disk, so later launches skip compiling shaders that haven't changed.
+	ProgramBinaryCache::Init("shadercache");
+	Shader::InitParallelCompile();
+
+#ifndef NDEBUG
+	// Saving a .shader file rebuilds it in place while the app keeps running.
+	Shader::EnableHotReload();
+#endif
+
+	if (argc > 1 && std::string(argv[1]) == "--bench") {
+		RunBenchmarks(window);
+		GLDebug::PrintReport();
+		glfwTerminate();
+		return 0;
+	}
+
 	
 	float positions[] = {
 		-0.5f, -0.5f,
@@ -60,61 +110,89 @@ int main()
 		2, 3, 0 
 	}; 
 
-	// Vertex Array Object (VAO) and Vertex Buffer Object (VBO) and Index Buffer Object (IBO)
-	VertexArray*  va = new VertexArray();
-	VertexBuffer* vb = new VertexBuffer(positions, (4 * 2) * sizeof(float));
-	IndexBuffer*  ib =  new IndexBuffer(indices, 6);
+	// Everything that owns a GL object lives inside this scope, so it is destroyed while the context still exists (before glfwTerminate()).
+	{
+		// The pools own the GL resources, the rest of the code only keeps 32 bit handles to them.
+		ResourcePool<VertexArray> vertexArrays;
+		ResourcePool<VertexBuffer> vertexBuffers;
+		ResourcePool<IndexBuffer> indexBuffers;
+		ResourcePool<Shader> shaders;
+
+		// Vertex Array Object (VAO) and Vertex Buffer Object (VBO) and Index Buffer Object (IBO)
+		ResourceHandle<VertexArray>  vaHandle = vertexArrays.Create();
+		ResourceHandle<VertexBuffer> vbHandle = vertexBuffers.Create(positions, (4 * 2) * sizeof(float));
+		ResourceHandle<IndexBuffer>  ibHandle = indexBuffers.Create(indices, 6);
+		ResourceHandle<Shader>   shaderHandle = shaders.Create("res/shaders/Basic.shader", ShaderCompileMode::Async); // drawn flat grey until it has compiled
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		vertexArrays.Get(vaHandle)->AddBuffer(*vertexBuffers.Get(vbHandle), layout);
+
+		// Every shader with a 'Material' block reads u_Color from this buffer, it is written once per frame with a single glBufferSubData().
+		UniformBuffer material("Material", sizeof(MaterialUniforms));
+		material.Set(MaterialUniforms{ { 0.8f, 0.3f, 0.8f, 1.0f } });
+		material.Bind();
+
+		Shader* shader = shaders.Get(shaderHandle);
+	
+		// These are empty inline functions in release builds, in debug builds they go through GLState like the binds do.
+		shader->Unbind();                        // GLCall(glUseProgram(0); 
+		vertexArrays.Get(vaHandle)->Unbind();    // GLCall(glBindVertexArray(0));
+		vertexBuffers.Get(vbHandle)->Unbind();   // GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+		indexBuffers.Get(ibHandle)->Unbind();    // GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 
-	VertexBufferLayout* layout = new VertexBufferLayout();
-	layout->Push<float>(2);
-	va->AddBuffer(*vb, *layout);
+		std::cout << "[Shader] Program binary cache: " << ProgramBinaryCache::GetHitCount() << " loaded, " << ProgramBinaryCache::GetMissCount() 
+			<< " compiled from source" << std::endl;
 
+		Renderer renderer;
 
-	Shader* shader = new Shader("res/shaders/Basic.shader");
-	shader->Bind();
-	shader->SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
-	
-	shader->Unbind(); // GLCall(glUseProgram(0); 
-	va->Unbind();     // GLCall(glBindVertexArray(0));
-	vb->Unbind();     // GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-	ib->Unbind();     // GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+		float r = 0.0f;
+		float increment = 0.01f;
 
-	Renderer* renderer = new Renderer();
+		/* Loop until the user closes the window */
+		while (!glfwWindowShouldClose(window))
+		{
+			Shader::ProcessHotReload();
 
-	float r = 0.0f;
-	float increment = 0.01f;
+			// Pointers into a pool are only valid until the pool changes, so they are looked up again every frame.
+			const VertexArray* va = vertexArrays.Get(vaHandle);
+			const IndexBuffer* ib = indexBuffers.Get(ibHandle);
+			Shader* shader = shaders.Get(shaderHandle);
 
-	/* Loop until the user closes the window */
-	while (!glfwWindowShouldClose(window))
-	{
-		/* Render here */
-		renderer->Clear(); // GLCall(glClear(GL_COLOR_BUFFER_BIT));
-		renderer->Draw(*va, *ib, *shader); // this now bind the VAO, IBO and Shader
+			/* Render here */
+			renderer.Clear(); // GLCall(glClear(GL_COLOR_BUFFER_BIT));
+			renderer.ResetStats();
+			renderer.Submit(*va, *ib, *shader); // queues the draw, the VAO, IBO and Shader are bound when the queue is flushed
+			renderer.Flush();
+
+			// The whole block is uploaded at once, every shader with a 'Material' block sees the new colour.
+			material.Set(MaterialUniforms{ { r, 0.3f, 0.8f, 1.0f } });
 
-		// uniform is set per draw call, unlike vertex attributes which are set per vertex. 
-		shader->SetUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
 
+			if (r > 1.0f)
+				increment = -0.01f;
+			else if (r < 0.0f)
+				increment = 0.01f;
 
-		if (r > 1.0f)
-			increment = -0.01f;
-		else if (r < 0.0f)
-			increment = 0.01f;
+			r += increment;
 
-		r += increment;
+			/* Swap front and back buffers */
+			glfwSwapBuffers(window);
 
-		/* Swap front and back buffers */
-		glfwSwapBuffers(window);
+			// Frees the GL objects released a few frames ago that the GPU has finished with.
+			DeletionQueue::EndFrame();
 
-		/* Poll for and process events */
-		glfwPollEvents();
+			/* Poll for and process events */
+			glfwPollEvents();
+		}
 	}
 
-	delete renderer;
-	delete shader;
-	delete va;
-	delete vb;
-	delete layout;
-	delete ib;
+	VertexFormatCache::Clear();
+	ShaderPermutationCache::Clear();
+	Shader::DisableHotReload();
+	Shader::ReleaseFallbackProgram();
+	DeletionQueue::Flush();
+	GLDebug::PrintReport();
 
 	glfwTerminate();
 	return 0;
@@ -0,0 +1,166 @@
+#include "BatchRenderer.h"
+
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+#include "DeletionQueue.h"
+
+
+BatchRenderer::BatchRenderer()
+	: m_VertexStream(GL_ARRAY_BUFFER, BatchesPerFrame * MaxVertices * sizeof(QuadVertex)), m_IndexBuffer(GenerateQuadIndices(MaxQuads).data(), MaxIndices), 
+	  m_Shader("res/shaders/Batch.shader"), m_BatchVertices(nullptr), m_VertexCount(0), m_BaseVertex(0), m_WhiteTexture(0), m_TextureSlotCount(1)
+{
+	using QuadLayout = Layout<
+		Attr<float, 2>,  // a_Position
+		Attr<float, 4>,  // a_Color
+		Attr<float, 2>,  // a_TexCoord
+		Attr<float, 1>>; // a_TexIndex
+	static_assert(QuadLayout::Stride == sizeof(QuadVertex), "QuadLayout doesn't match QuadVertex");
+	m_VertexArray.AddBuffer(m_VertexStream, QuadLayout());
+
+	// 1x1 white texture, so coloured quads and textured quads can share a batch (colour * white = colour).
+	unsigned int white = 0xFFFFFFFF;
+	GLCall(glGenTextures(1, &m_WhiteTexture));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_WhiteTexture));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white));
+	m_TextureSlots[0] = m_WhiteTexture;
+
+	// Sampler i reads from texture unit i, this never changes so it is only set once.
+	int samplers[MaxTextureSlots];
+	for (unsigned int i = 0; i < MaxTextureSlots; i++)
+		samplers[i] = (int)i;
+	m_Shader.Bind();
+	m_Shader.SetUniform1iv("u_Textures", MaxTextureSlots, samplers);
+}
+
+BatchRenderer::~BatchRenderer() {
+
+	DeletionQueue::Release(GLObjectType::Texture, m_WhiteTexture);
+}
+
+std::vector<unsigned int> BatchRenderer::GenerateQuadIndices(unsigned int quadCount) {
+
+	std::vector<unsigned int> indices(quadCount * 6);
+	for (unsigned int quad = 0; quad < quadCount; quad++) {
+		unsigned int vertex = quad * 4;
+		indices[quad * 6 + 0] = vertex + 0;
+		indices[quad * 6 + 1] = vertex + 1;
+		indices[quad * 6 + 2] = vertex + 2;
+		indices[quad * 6 + 3] = vertex + 2;
+		indices[quad * 6 + 4] = vertex + 3;
+		indices[quad * 6 + 5] = vertex + 0;
+	}
+	return indices;
+}
+
+void BatchRenderer::Begin() {
+
+	ASSERT(m_BatchVertices == nullptr); // the previous frame has to be finished with End()
+	m_TextureSlotCount = 1;
+}
+
+void BatchRenderer::End() {
+
+	Flush();
+	m_VertexStream.EndFrame();
+}
+
+void BatchRenderer::DrawQuad(float x, float y, float width, float height, const float color[4]) {
+
+	if (m_VertexCount >= MaxVertices)
+		Flush();
+
+	PushQuad(x, y, width, height, color, 0.0f);
+}
+
+void BatchRenderer::DrawQuad(float x, float y, float width, float height, unsigned int texture, const float tint[4]) {
+
+	if (m_VertexCount >= MaxVertices)
+		Flush();
+
+	// Reuses the slot if the texture is already part of this batch.
+	unsigned int slot = 0;
+	for (unsigned int i = 1; i < m_TextureSlotCount; i++) {
+		if (m_TextureSlots[i] == texture) {
+			slot = i;
+			break;
+		}
+	}
+
+	if (slot == 0) {
+		// Changing the bound textures in the middle of a batch would change them for the quads already in it, so the batch has to be drawn first.
+		if (m_TextureSlotCount == MaxTextureSlots)
+			Flush();
+
+		slot = m_TextureSlotCount++;
+		m_TextureSlots[slot] = texture;
+	}
+
+	PushQuad(x, y, width, height, tint, (float)slot);
+}
+
+void BatchRenderer::PushQuad(float x, float y, float width, float height, const float color[4], float texIndex) {
+
+	if (m_BatchVertices == nullptr)
+		MapBatch();
+
+	const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+	// The mapped memory is write-only (and possibly uncached), so every field is written exactly once and nothing is read back.
+	for (const auto& corner : corners) {
+		QuadVertex& vertex = m_BatchVertices[m_VertexCount++];
+		vertex.Position[0] = x + corner[0] * width;
+		vertex.Position[1] = y + corner[1] * height;
+		vertex.Color[0] = color[0];
+		vertex.Color[1] = color[1];
+		vertex.Color[2] = color[2];
+		vertex.Color[3] = color[3];
+		vertex.TexCoord[0] = corner[0];
+		vertex.TexCoord[1] = corner[1];
+		vertex.TexIndex = texIndex;
+	}
+}
+
+void BatchRenderer::MapBatch() {
+
+	// Aligned to a whole vertex, so the start of the batch can be expressed as a base vertex.
+	StreamAllocation allocation = m_VertexStream.Map(MaxVertices * sizeof(QuadVertex), sizeof(QuadVertex));
+	m_BatchVertices = (QuadVertex*)allocation.Pointer;
+	m_BaseVertex = allocation.Offset / sizeof(QuadVertex);
+	m_VertexCount = 0;
+}
+
+void BatchRenderer::Flush() {
+
+	if (m_BatchVertices == nullptr)
+		return;
+
+	m_VertexStream.Unmap(m_VertexCount * sizeof(QuadVertex));
+	m_BatchVertices = nullptr;
+
+	const unsigned int quadCount = m_VertexCount / 4;
+	m_VertexCount = 0;
+	if (quadCount == 0)
+		return;
+
+	for (unsigned int i = 0; i < m_TextureSlotCount; i++) {
+		GLCall(glActiveTexture(GL_TEXTURE0 + i));
+		GLCall(glBindTexture(GL_TEXTURE_2D, m_TextureSlots[i]));
+	}
+
+	m_Shader.Bind();
+	m_VertexArray.Bind();
+	m_IndexBuffer.Bind();
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, quadCount * 6, GL_UNSIGNED_INT, nullptr, m_BaseVertex));
+
+	m_Stats.DrawCalls++;
+	m_Stats.QuadCount += quadCount;
+
+	m_TextureSlotCount = 1;
+}
+
+void BatchRenderer::ResetStats() {
+
+	m_Stats = BatchStats();
+}
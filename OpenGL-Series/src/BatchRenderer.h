@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include "VertexArray.h"
+#include "StreamBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+
+
+// One corner of a quad, exactly as it is stored in the vertex buffer. See res/shaders/Batch.shader for the matching attributes.
+struct QuadVertex {
+
+	float Position[2];
+	float Color[4];
+	float TexCoord[2];
+	float TexIndex; // texture slot, 0 is the built-in white texture for plain coloured quads
+};
+
+// Counts for the frame so far, reset with BatchRenderer::ResetStats().
+struct BatchStats {
+
+	unsigned int DrawCalls = 0;
+	unsigned int QuadCount = 0;
+};
+
+// Notes regarding BatchRenderer
+/*
+	Drawing a quad with Renderer::Draw() costs a draw call (plus uniform updates) per quad, which falls over long before tens of thousands of sprites.
+
+	The batch renderer instead writes the 4 vertices of every quad straight into memory mapped from a StreamBuffer. When the batch is full, when a quad needs a
+	texture and all the texture slots are taken, or when End() is called, the batch is drawn with a single glDrawElementsBaseVertex(), the base vertex selects 
+	where in the stream buffer the batch was written. The index buffer never changes (every quad is 0,1,2,2,3,0 shifted by 4 per quad), so it is generated 
+	once for the maximum number of quads.
+*/
+class BatchRenderer {
+
+private:
+
+	static const unsigned int MaxQuads = 10000;
+	static const unsigned int MaxVertices = MaxQuads * 4;
+	static const unsigned int MaxIndices = MaxQuads * 6;
+	static const unsigned int MaxTextureSlots = 16; // has to match the size of u_Textures in Batch.shader
+	static const unsigned int BatchesPerFrame = 4;  // how many full batches a frame of the stream buffer has room for before it has to wait on the GPU
+
+	VertexArray m_VertexArray;
+	StreamBuffer m_VertexStream;
+	IndexBuffer m_IndexBuffer;
+	Shader m_Shader;
+
+	QuadVertex* m_BatchVertices;  // mapped stream buffer memory of the current batch, nullptr until the first quad of the batch
+	unsigned int m_VertexCount;
+	unsigned int m_BaseVertex;    // where the current batch starts in the stream buffer, in vertices
+
+	unsigned int m_WhiteTexture;
+	unsigned int m_TextureSlots[MaxTextureSlots]; // GL texture names, slot i is bound to texture unit i when the batch is flushed
+	unsigned int m_TextureSlotCount;
+
+	BatchStats m_Stats;
+
+public:
+
+	BatchRenderer();
+	~BatchRenderer();
+
+	BatchRenderer(const BatchRenderer&) = delete;
+	BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+	void Begin();
+	void End();
+
+	// Positions and sizes are in clip space (-1 to 1), (x, y) is the bottom left corner.
+	void DrawQuad(float x, float y, float width, float height, const float color[4]);
+	void DrawQuad(float x, float y, float width, float height, unsigned int texture, const float tint[4]);
+
+	// Draws everything queued so far, called automatically when the batch can't take another quad.
+	void Flush();
+
+	inline const BatchStats& GetStats() const { return m_Stats; }
+	void ResetStats();
+
+private:
+
+	void PushQuad(float x, float y, float width, float height, const float color[4], float texIndex);
+	void MapBatch();
+	static std::vector<unsigned int> GenerateQuadIndices(unsigned int quadCount);
+};
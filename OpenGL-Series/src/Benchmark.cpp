@@ -0,0 +1,432 @@
+#include "Benchmark.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+#include "DeletionQueue.h"
+
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "ShaderPermutationCache.h"
+#include "BatchRenderer.h"
+#include "Std140.h"
+#include "UniformBuffer.h"
+#include "MappedFile.h"
+#include "ShaderParser.h"
+#include "VertexFormatCache.h"
+
+
+// Measures the wall clock time of a frame including the GPU work, glFinish() blocks until the GPU is done with everything that was submitted.
+class FrameTimer {
+
+private:
+
+	std::chrono::high_resolution_clock::time_point m_Start;
+
+public:
+
+	FrameTimer() : m_Start(std::chrono::high_resolution_clock::now()) {}
+
+	double ElapsedMilliseconds() const {
+		GLCall(glFinish());
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_Start).count();
+	}
+};
+
+void RunBenchmarks(GLFWwindow* window) {
+
+	glfwSwapInterval(0); // Vsync would cap every benchmark at the refresh rate
+
+	BenchmarkInstancing(window, 100000, 60);
+	BenchmarkVertexFormats(window, 10000, 60);
+	BenchmarkBatchRenderer(window, 50000, 60);
+	BenchmarkShaderParsing(1000, 300, 5);
+
+	VertexFormatCache::Clear();
+	ShaderPermutationCache::Clear();
+	Shader::ReleaseFallbackProgram();
+	DeletionQueue::Flush(); // the benchmarks never call EndFrame(), everything they released is still queued
+}
+
+void BenchmarkInstancing(GLFWwindow* window, unsigned int quadCount, unsigned int frameCount) {
+
+	float positions[] = {
+		-0.5f, -0.5f,
+		 0.5f, -0.5f,
+		 0.5f,  0.5f,
+		-0.5f,  0.5f
+	};
+
+	unsigned int indices[] = { 
+		0, 1, 2,
+		2, 3, 0 
+	}; 
+
+	struct QuadInstance {
+		float Offset[2];
+		unsigned char Color[4];
+	};
+
+	// The 'Draw' block of Quad.shader with PER_DRAW_BLOCK, written per draw into the renderer's UniformRing.
+	struct QuadUniforms {
+		Std140::vec4 Color;
+		Std140::vec2 Offset;
+		float Scale;
+	};
+	STD140_FIRST(QuadUniforms, Color);
+	STD140_NEXT(QuadUniforms, Color, Offset);
+	STD140_NEXT(QuadUniforms, Offset, Scale);
+	STD140_END(QuadUniforms);
+
+	// Spreads the quads over a square grid that covers the whole window.
+	unsigned int columns = 1;
+	while (columns * columns < quadCount)
+		columns++;
+	const float cellSize = 2.0f / columns;
+
+	std::vector<QuadInstance> instances(quadCount);
+	for (unsigned int i = 0; i < quadCount; i++) {
+		QuadInstance& instance = instances[i];
+		instance.Offset[0] = -1.0f + cellSize * (i % columns + 0.5f);
+		instance.Offset[1] = -1.0f + cellSize * (i / columns + 0.5f);
+		instance.Color[0] = (unsigned char)(i * 37);
+		instance.Color[1] = (unsigned char)(i * 101);
+		instance.Color[2] = (unsigned char)(i * 173);
+		instance.Color[3] = 255;
+	}
+
+	VertexArray va;
+	VertexBuffer vb(positions, (4 * 2) * sizeof(float));
+	IndexBuffer ib(indices, 6);
+
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	va.AddBuffer(vb, layout);
+
+	VertexBuffer instanceBuffer(instances.data(), quadCount * sizeof(QuadInstance));
+	VertexBufferLayout instanceLayout;
+	instanceLayout.Push<float>(2);         // a_Offset, location 1
+	instanceLayout.Push<unsigned char>(4); // a_Color,  location 2
+	instanceLayout.SetInstanceDivisor(1);
+	va.AddBuffer(instanceBuffer, instanceLayout);
+
+	// All three paths draw the same grid cells: Quad.shader reads the offset, scale and colour Instanced.shader gets per instance from per-draw values,
+	// so the comparison is about draw call overhead rather than how many pixels get filled.
+	const float scale = cellSize * 0.8f;
+	Shader& quadShader = ShaderPermutationCache::Get("res/shaders/Quad.shader"); // shared, built once however many benchmarks use it
+	Shader& quadRingShader = ShaderPermutationCache::Get("res/shaders/Quad.shader", { { "PER_DRAW_BLOCK", "" } });
+	Shader instancedShader("res/shaders/Instanced.shader");
+	instancedShader.Bind();
+	instancedShader.SetUniform1f("u_Scale", scale);
+	quadShader.Bind();
+	quadShader.SetUniform1f("u_Scale", scale);
+
+	Renderer renderer;
+
+	// Baseline: one Draw() per quad, u_Color and u_Offset changed with SetUniform*() between the draws. Rewriting one shared UniformBuffer per draw 
+	// instead would make the driver stall or orphan it every time and inflate the baseline.
+	double loopedMs = 0.0;
+	unsigned int loopedFrames = 0;
+	for (; loopedFrames < frameCount && !glfwWindowShouldClose(window); loopedFrames++) {
+
+		FrameTimer timer;
+		renderer.Clear();
+		for (unsigned int i = 0; i < quadCount; i++) {
+			const QuadInstance& instance = instances[i];
+			quadShader.SetUniform4f("u_Color", instance.Color[0] / 255.0f, instance.Color[1] / 255.0f, instance.Color[2] / 255.0f, 1.0f);
+			quadShader.SetUniform2f("u_Offset", instance.Offset[0], instance.Offset[1]);
+			renderer.Draw(va, ib, quadShader);
+		}
+		loopedMs += timer.ElapsedMilliseconds();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// Same draws queued with SubmitWithUniforms(): every colour goes into its own UniformRing slot, uploaded once per frame and selected per draw with
+	// glBindBufferRange(). Each slot is padded to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT (often 256 bytes), which is part of what this measures.
+	Renderer ringRenderer; // per-draw uniforms go to the "Draw" block by default
+
+	double ringMs = 0.0;
+	unsigned int ringFrames = 0;
+	for (; ringFrames < frameCount && !glfwWindowShouldClose(window); ringFrames++) {
+
+		FrameTimer timer;
+		ringRenderer.Clear();
+		for (unsigned int i = 0; i < quadCount; i++) {
+			const QuadInstance& instance = instances[i];
+			QuadUniforms uniforms = { { instance.Color[0] / 255.0f, instance.Color[1] / 255.0f, instance.Color[2] / 255.0f, 1.0f }, 
+				{ instance.Offset[0], instance.Offset[1] }, scale };
+			ringRenderer.SubmitWithUniforms(va, ib, quadRingShader, &uniforms, sizeof(uniforms));
+		}
+		ringRenderer.Flush();
+		ringMs += timer.ElapsedMilliseconds();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// Instanced: the whole grid in one draw call.
+	double instancedMs = 0.0;
+	unsigned int instancedFrames = 0;
+	for (; instancedFrames < frameCount && !glfwWindowShouldClose(window); instancedFrames++) {
+
+		FrameTimer timer;
+		renderer.Clear();
+		renderer.DrawInstanced(va, ib, instancedShader, quadCount);
+		instancedMs += timer.ElapsedMilliseconds();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	// The window may have been closed part way, only the frames actually drawn count.
+	if (loopedFrames == 0 || ringFrames == 0 || instancedFrames == 0)
+		return;
+	loopedMs /= loopedFrames;
+	ringMs /= ringFrames;
+	instancedMs /= instancedFrames;
+
+	std::cout << "[Benchmark] Instancing, " << quadCount << " quads" << std::endl;
+	std::cout << "  Draw() loop:     " << loopedMs << " ms/frame (" << quadCount << " draw calls)" << std::endl;
+	std::cout << "  UniformRing:     " << ringMs << " ms/frame (" << quadCount << " draw calls, " << quadCount << " ring slots)" << std::endl;
+	std::cout << "  DrawInstanced(): " << instancedMs << " ms/frame (1 draw call)" << std::endl;
+	std::cout << "  Speedup:         " << loopedMs / instancedMs << "x over the Draw() loop" << std::endl;
+}
+
+void BenchmarkVertexFormats(GLFWwindow* window, unsigned int meshCount, unsigned int frameCount) {
+
+	unsigned int indices[] = { 
+		0, 1, 2,
+		2, 3, 0 
+	}; 
+
+	struct MeshMaterial {
+		Std140::vec4 Color;
+	};
+	STD140_FIRST(MeshMaterial, Color);
+	STD140_END(MeshMaterial);
+
+	unsigned int columns = 1;
+	while (columns * columns < meshCount)
+		columns++;
+	const float cellSize = 2.0f / columns;
+
+	// Every mesh is a quad in its own vertex buffer, with the position of its grid cell baked into the vertices.
+	std::vector<VertexBuffer> vertexBuffers;
+	vertexBuffers.reserve(meshCount);
+	for (unsigned int i = 0; i < meshCount; i++) {
+		const float x = -1.0f + cellSize * (i % columns);
+		const float y = -1.0f + cellSize * (i / columns);
+		const float size = cellSize * 0.8f;
+		float positions[] = {
+			x,        y,
+			x + size, y,
+			x + size, y + size,
+			x,        y + size
+		};
+		vertexBuffers.emplace_back(positions, (4 * 2) * (unsigned int)sizeof(float));
+	}
+	IndexBuffer ib(indices, 6);
+
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+
+	// The usual way: a VAO per mesh, all with the same attribute setup.
+	std::vector<VertexArray> vertexArrays(meshCount);
+	for (unsigned int i = 0; i < meshCount; i++)
+		vertexArrays[i].AddBuffer(vertexBuffers[i], layout);
+
+	const VertexFormat format = VertexFormatCache::Intern(layout);
+
+	Shader& basicShader = ShaderPermutationCache::Get("res/shaders/Basic.shader");
+	UniformBuffer material("Material", sizeof(MeshMaterial));
+	material.Set(MeshMaterial{ { 0.2f, 0.7f, 0.4f, 1.0f } });
+	material.Bind();
+
+	Renderer renderer;
+
+	double perMeshMs = 0.0;
+	unsigned int perMeshFrames = 0;
+	for (; perMeshFrames < frameCount && !glfwWindowShouldClose(window); perMeshFrames++) {
+
+		FrameTimer timer;
+		renderer.Clear();
+		for (unsigned int i = 0; i < meshCount; i++)
+			renderer.Draw(vertexArrays[i], ib, basicShader);
+		perMeshMs += timer.ElapsedMilliseconds();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	double sharedMs = 0.0;
+	unsigned int sharedFrames = 0;
+	for (; sharedFrames < frameCount && !glfwWindowShouldClose(window); sharedFrames++) {
+
+		FrameTimer timer;
+		renderer.Clear();
+		for (unsigned int i = 0; i < meshCount; i++)
+			renderer.Draw(format, vertexBuffers[i], ib, basicShader);
+		sharedMs += timer.ElapsedMilliseconds();
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	if (perMeshFrames == 0 || sharedFrames == 0)
+		return;
+	perMeshMs /= perMeshFrames;
+	sharedMs /= sharedFrames;
+
+	std::cout << "[Benchmark] Vertex formats, " << meshCount << " meshes (separate attribute format " 
+		<< (VertexFormatCache::IsSeparateFormatSupported() ? "supported" : "not supported, one VAO per buffer") << ")" << std::endl;
+	std::cout << "  VAO per mesh:      " << perMeshMs << " ms/frame (" << meshCount << " VAOs)" << std::endl;
+	std::cout << "  VertexFormatCache: " << sharedMs << " ms/frame (" << VertexFormatCache::GetVertexArrayCount() << " VAOs)" << std::endl;
+	std::cout << "  Speedup:           " << perMeshMs / sharedMs << "x" << std::endl;
+}
+
+void BenchmarkBatchRenderer(GLFWwindow* window, unsigned int quadCount, unsigned int frameCount) {
+
+	unsigned int columns = 1;
+	while (columns * columns < quadCount)
+		columns++;
+	const float cellSize = 2.0f / columns;
+
+	BatchRenderer batch;
+	Renderer renderer;
+
+	double totalMs = 0.0;
+	unsigned long long totalQuads = 0;
+	unsigned int totalDrawCalls = 0;
+	unsigned int frames = 0;
+
+	for (; frames < frameCount && !glfwWindowShouldClose(window); frames++) {
+
+		FrameTimer timer;
+		renderer.Clear();
+		batch.ResetStats();
+		batch.Begin();
+		for (unsigned int i = 0; i < quadCount; i++) {
+			// Moves a little every frame, so the data really is dynamic.
+			float x = -1.0f + cellSize * (i % columns) + cellSize * 0.1f * (frames % 10) / 10.0f;
+			float y = -1.0f + cellSize * (i / columns);
+			float color[4] = { (i % 255) / 255.0f, 0.3f, 0.8f, 1.0f };
+			batch.DrawQuad(x, y, cellSize * 0.8f, cellSize * 0.8f, color);
+		}
+		batch.End();
+		totalMs += timer.ElapsedMilliseconds();
+
+		totalQuads += batch.GetStats().QuadCount;
+		totalDrawCalls += batch.GetStats().DrawCalls;
+
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	if (frames == 0)
+		return;
+
+	std::cout << "[Benchmark] BatchRenderer, " << quadCount << " quads" << std::endl;
+	std::cout << "  " << totalMs / frames << " ms/frame" << std::endl;
+	std::cout << "  " << totalQuads / (totalMs / 1000.0) << " quads/sec" << std::endl;
+	std::cout << "  " << (double)totalDrawCalls / frames << " draw calls/frame" << std::endl;
+}
+
+// The parser Shader used before ShaderParser: a stream, a getline() copy per line, a find() per line and a stringstream per stage. Kept here as the baseline.
+static size_t ParseWithStreams(const std::string& filepath) {
+
+	std::ifstream stream(filepath);
+	std::string line;
+	std::stringstream ss[2];
+	int type = 0;
+
+	while (getline(stream, line)) {
+		if (line.find("#shader") != std::string::npos) {
+			if (line.find("vertex") != std::string::npos)
+				type = 0;
+			else if (line.find("fragment") != std::string::npos)
+				type = 1;
+		}
+		else {
+			ss[type] << line << '\n';
+		}
+	}
+	return ss[0].str().size() + ss[1].str().size();
+}
+
+static size_t ParseMapped(const std::string& filepath) {
+
+	MappedFile file(filepath);
+	const ShaderFileSlices slices = ShaderParser::Parse(file.GetView(), filepath);
+
+	size_t size = 0;
+	for (const std::string_view& stage : slices.Stages)
+		size += stage.size();
+	return size;
+}
+
+void BenchmarkShaderParsing(unsigned int fileCount, unsigned int linesPerStage, unsigned int passes) {
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "opengl-series-shader-bench";
+	std::filesystem::create_directories(directory);
+
+	std::vector<std::string> files;
+	size_t totalBytes = 0;
+	static const char* stages[] = { "vertex", "geometry", "fragment" };
+
+	for (unsigned int i = 0; i < fileCount; i++) {
+
+		std::string text;
+		for (const char* stage : stages) {
+			text += std::string("#shader ") + stage + "\n#version 330 core\n\n";
+			for (unsigned int line = 0; line < linesPerStage; line++)
+				text += "\tvec4 v" + std::to_string(line) + " = vec4(" + std::to_string(i) + ".0, " + std::to_string(line) + ".0, 0.0, 1.0); // generated\n";
+			text += "\n";
+		}
+
+		files.push_back((directory / ("shader" + std::to_string(i) + ".shader")).string());
+		std::ofstream(files.back(), std::ios::binary) << text;
+		totalBytes += text.size();
+	}
+
+	// Best of 'passes', the first pass also pulls the files into the OS cache so both parsers read from memory.
+	double streamMs = 1e30;
+	double mappedMs = 1e30;
+	size_t checksum = 0;
+
+	for (unsigned int pass = 0; pass < passes; pass++) {
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (const std::string& file : files)
+			checksum += ParseWithStreams(file);
+		auto middle = std::chrono::high_resolution_clock::now();
+		for (const std::string& file : files)
+			checksum += ParseMapped(file);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		streamMs = std::min(streamMs, std::chrono::duration<double, std::milli>(middle - start).count());
+		mappedMs = std::min(mappedMs, std::chrono::duration<double, std::milli>(end - middle).count());
+	}
+
+	std::filesystem::remove_all(directory);
+
+	const double megabytes = totalBytes / (1024.0 * 1024.0);
+	std::cout << "[Benchmark] Shader parsing, " << fileCount << " files, " << megabytes << " MB (checksum " << checksum << ")" << std::endl;
+	std::cout << "  ifstream + getline: " << streamMs << " ms (" << megabytes / (streamMs / 1000.0) << " MB/s, " << fileCount / (streamMs / 1000.0) << " files/s)" << std::endl;
+	std::cout << "  mmap + slices:      " << mappedMs << " ms (" << megabytes / (mappedMs / 1000.0) << " MB/s, " << fileCount / (mappedMs / 1000.0) << " files/s)" << std::endl;
+	std::cout << "  Speedup:            " << streamMs / mappedMs << "x" << std::endl;
+}
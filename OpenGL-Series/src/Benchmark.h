@@ -0,0 +1,22 @@
+#pragma once
+
+struct GLFWwindow;
+
+
+// Benchmarks are started with the "--bench" command line argument instead of the normal render loop. Every benchmark prints its own results to the console.
+void RunBenchmarks(GLFWwindow* window);
+
+// Draws 'quadCount' coloured quads per frame three ways: a loop of Renderer::Draw() setting the uniforms before every draw, a loop of 
+// Renderer::SubmitWithUniforms() (per-draw UniformRing slots, one upload per frame) and a single Renderer::DrawInstanced().
+void BenchmarkInstancing(GLFWwindow* window, unsigned int quadCount, unsigned int frameCount);
+
+// Draws 'meshCount' meshes of the same layout, each in its own vertex buffer, once with a VertexArray per mesh and once through the shared VAO of
+// VertexFormatCache (only the vertex buffer binding changes between meshes).
+void BenchmarkVertexFormats(GLFWwindow* window, unsigned int meshCount, unsigned int frameCount);
+
+// Streams 'quadCount' coloured quads per frame through the BatchRenderer and reports quads/sec and draw calls per frame.
+void BenchmarkBatchRenderer(GLFWwindow* window, unsigned int quadCount, unsigned int frameCount);
+
+// Generates a library of 'fileCount' .shader files (vertex, geometry and fragment stage of 'linesPerStage' lines each) and splits all of them into stages,
+// once with the old ifstream/getline parser and once with MappedFile + ShaderParser. Reports MB/s and files/s of the best of 'passes' runs. No GL involved.
+void BenchmarkShaderParsing(unsigned int fileCount, unsigned int linesPerStage, unsigned int passes);
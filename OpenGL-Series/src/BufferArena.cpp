@@ -0,0 +1,53 @@
+#include "BufferArena.h"
+
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "DirectStateAccess.h"
+
+
+BufferArena::BufferArena(unsigned int blockSize)
+	: m_BlockSize(blockSize)
+{
+}
+
+BufferArena::~BufferArena() {
+
+	for (const Block& block : m_Blocks)
+		DeletionQueue::Release(GLObjectType::Buffer, block.RendererID);
+}
+
+BufferView BufferArena::Allocate(unsigned int size, unsigned int alignment) {
+
+	for (unsigned int i = 0; i < m_Blocks.size(); i++) {
+		unsigned int offset = m_Blocks[i].Allocator.Allocate(size, alignment);
+		if (offset != OffsetAllocator::InvalidOffset)
+			return { m_Blocks[i].RendererID, offset, size, i };
+	}
+
+	unsigned int block = CreateBlock(size > m_BlockSize ? size : m_BlockSize);
+	unsigned int offset = m_Blocks[block].Allocator.Allocate(size, alignment); // always succeeds, offset 0 of an empty block is aligned to anything
+	return { m_Blocks[block].RendererID, offset, size, block };
+}
+
+void BufferArena::Free(const BufferView& view) {
+
+	m_Blocks[view.Block].Allocator.Free(view.Offset, view.Size);
+}
+
+void BufferArena::Upload(const BufferView& view, const void* data, unsigned int size, unsigned int offset) {
+
+	ASSERT(offset + size <= view.Size);
+
+	// Without DSA this goes through GL_COPY_WRITE_BUFFER, it isn't used for drawing, so it doesn't disturb the bound VBO, or the IBO binding of the bound VAO.
+	DirectStateAccess::BufferSubData(view.RendererID, GL_COPY_WRITE_BUFFER, view.Offset + offset, size, data);
+}
+
+unsigned int BufferArena::CreateBlock(unsigned int size) {
+
+	unsigned int rendererID = DirectStateAccess::CreateBuffer(GL_COPY_WRITE_BUFFER);
+	DirectStateAccess::BufferData(rendererID, GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+
+	m_Blocks.push_back({ rendererID, OffsetAllocator(size) });
+	return (unsigned int)m_Blocks.size() - 1;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include "OffsetAllocator.h"
+
+
+// A range inside one of the arena's GL buffers. This is all a VertexBuffer/IndexBuffer created from an arena stores about its data.
+struct BufferView {
+
+	unsigned int RendererID; // the shared GL buffer
+	unsigned int Offset;     // in bytes
+	unsigned int Size;       // in bytes
+	unsigned int Block;      // index of the block inside the arena, needed to free the range again
+};
+
+// Notes regarding BufferArena
+/*
+	With one GL buffer per mesh, thousands of meshes means thousands of driver allocations and a buffer bind for every draw. The arena instead creates a few 
+	big buffers (blocks) and places each mesh inside one of them with an OffsetAllocator. 
+
+	Meshes that live in the same block can share one VAO (the attributes point at the start of the block) and one bound IBO, each draw selects its mesh with
+	the first index and a base vertex (see MeshRange and Renderer::DrawRange()/DrawIndirect()). A VAO built from a single view also works with Renderer::Draw()
+	and Submit(), VertexArray remembers the view's base vertex and they draw with it. For the base vertex to work, vertex data is allocated aligned to
+	its stride, so that the offset is a whole number of vertices.
+
+	An allocation that doesn't fit into any block gets a new block (or a dedicated one if it is bigger than the block size).
+*/
+class BufferArena {
+
+private:
+
+	struct Block {
+
+		unsigned int RendererID;
+		OffsetAllocator Allocator;
+	};
+
+	unsigned int m_BlockSize;
+	std::vector<Block> m_Blocks;
+
+public:
+
+	BufferArena(unsigned int blockSize = 64 * 1024 * 1024);
+	~BufferArena();
+
+	BufferArena(const BufferArena&) = delete;
+	BufferArena& operator=(const BufferArena&) = delete;
+
+	BufferView Allocate(unsigned int size, unsigned int alignment);
+	void Free(const BufferView& view);
+
+	// Writes 'size' bytes at 'offset' bytes into the view.
+	void Upload(const BufferView& view, const void* data, unsigned int size, unsigned int offset = 0);
+
+	inline unsigned int GetBlockCount() const { return (unsigned int)m_Blocks.size(); }
+
+private:
+
+	unsigned int CreateBlock(unsigned int size);
+};
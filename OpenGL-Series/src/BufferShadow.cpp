@@ -0,0 +1,58 @@
+#include "BufferShadow.h"
+
+#include <GL/glew.h>
+
+#include <cstring>
+
+
+unsigned int GetGLUsage(BufferUsage usage) {
+
+	switch (usage) {
+		case BufferUsage::Static:  return GL_STATIC_DRAW;
+		case BufferUsage::Dynamic: return GL_DYNAMIC_DRAW;
+		case BufferUsage::Stream:  return GL_STREAM_DRAW;
+	}
+	return GL_STATIC_DRAW;
+}
+
+void BufferShadow::Write(unsigned int offset, const void* data, unsigned int size) {
+
+	if (size == 0)
+		return;
+
+	if (m_Data.size() < offset + size)
+		m_Data.resize(offset + size);
+
+	memcpy(m_Data.data() + offset, data, size);
+	AddRange(offset, offset + size);
+}
+
+void BufferShadow::Clear() {
+
+	m_DirtyRanges.clear();
+}
+
+bool BufferShadow::CoversWholeBuffer(unsigned int size) const {
+
+	// The ranges never touch each other, so the whole buffer can only be covered by a single range.
+	return m_DirtyRanges.size() == 1 && m_DirtyRanges[0].Begin == 0 && m_DirtyRanges[0].End >= size;
+}
+
+void BufferShadow::AddRange(unsigned int begin, unsigned int end) {
+
+	// First range that ends at or after 'begin', everything before it is left alone.
+	auto first = m_DirtyRanges.begin();
+	while (first != m_DirtyRanges.end() && first->End < begin)
+		++first;
+
+	// Swallows every range that overlaps or touches [begin, end).
+	auto last = first;
+	while (last != m_DirtyRanges.end() && last->Begin <= end) {
+		if (last->Begin < begin) begin = last->Begin;
+		if (last->End > end) end = last->End;
+		++last;
+	}
+
+	first = m_DirtyRanges.erase(first, last);
+	m_DirtyRanges.insert(first, { begin, end });
+}
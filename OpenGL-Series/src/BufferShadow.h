@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+
+// How often the contents of a buffer are expected to change, passed on to glBufferData() as a hint for where the driver should put the memory.
+enum class BufferUsage {
+
+	Static,  // written once, drawn many times (GL_STATIC_DRAW)
+	Dynamic, // rewritten every now and then, drawn many times (GL_DYNAMIC_DRAW)
+	Stream   // rewritten about every time it's drawn (GL_STREAM_DRAW)
+};
+
+unsigned int GetGLUsage(BufferUsage usage);
+
+// A range of bytes [Begin, End) that has been written on the CPU but not uploaded yet.
+struct DirtyRange {
+
+	unsigned int Begin;
+	unsigned int End;
+};
+
+// Notes regarding BufferShadow
+/*
+	The CPU side copy behind VertexBuffer::SetSubData()/IndexBuffer::SetSubData(). Instead of a glBufferSubData() per write, writes are copied into the shadow
+	and the touched byte ranges are remembered. Overlapping and touching ranges are merged as they come in, so when the buffer is flushed, each changed 
+	region is uploaded with one glBufferSubData() and bytes that weren't touched are never uploaded.
+
+	Only the bytes inside dirty ranges are valid, the rest of the shadow is whatever it was initialised with. That's why ranges with a gap between them are
+	never merged: uploading the gap would overwrite the GPU copy with garbage.
+*/
+class BufferShadow {
+
+private:
+
+	std::vector<unsigned char> m_Data;
+	std::vector<DirtyRange> m_DirtyRanges; // sorted by Begin, never overlapping or touching
+
+public:
+
+	void Write(unsigned int offset, const void* data, unsigned int size);
+	void Clear();
+
+	// True if the dirty ranges cover all 'size' bytes, then the whole buffer can be replaced (orphaned) instead of patched.
+	bool CoversWholeBuffer(unsigned int size) const;
+
+	inline bool IsDirty() const { return !m_DirtyRanges.empty(); }
+	inline const std::vector<DirtyRange>& GetDirtyRanges() const { return m_DirtyRanges; }
+	inline const unsigned char* GetData() const { return m_Data.data(); }
+
+private:
+
+	void AddRange(unsigned int begin, unsigned int end);
+};
@@ -0,0 +1,124 @@
+#include "DeletionQueue.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "Renderer.h"
+#include "GLState.h"
+#include "VertexFormatCache.h"
+
+
+struct ReleasedObject {
+
+	GLObjectType Type;
+	unsigned int RendererID;
+};
+
+// Objects released during one frame and the fence that has to signal before they can be deleted.
+struct ReleasedBatch {
+
+	GLsync Fence;
+	std::vector<ReleasedObject> Objects;
+};
+
+static std::mutex s_ReleaseMutex;
+static std::vector<ReleasedObject> s_Released; // released since the last EndFrame(), guarded by s_ReleaseMutex
+
+static std::deque<ReleasedBatch> s_Batches;    // GL thread only, oldest first
+
+
+static void DeleteObject(const ReleasedObject& object) {
+
+	switch (object.Type) {
+		case GLObjectType::Buffer:
+			GLCall(glDeleteBuffers(1, &object.RendererID));
+			GLState::OnBufferDeleted(object.RendererID);
+			VertexFormatCache::OnBufferDeleted(object.RendererID);
+			break;
+		case GLObjectType::VertexArray:
+			GLCall(glDeleteVertexArrays(1, &object.RendererID));
+			GLState::OnVertexArrayDeleted(object.RendererID);
+			break;
+		case GLObjectType::Program:
+			GLCall(glDeleteProgram(object.RendererID));
+			GLState::OnProgramDeleted(object.RendererID);
+			break;
+		case GLObjectType::Texture:
+			GLCall(glDeleteTextures(1, &object.RendererID));
+			break;
+	}
+}
+
+static void DeleteBatch(ReleasedBatch& batch) {
+
+	for (const ReleasedObject& object : batch.Objects)
+		DeleteObject(object);
+
+	if (batch.Fence) {
+		GLCall(glDeleteSync(batch.Fence));
+	}
+}
+
+void DeletionQueue::Release(GLObjectType type, unsigned int rendererID) {
+
+	if (rendererID == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(s_ReleaseMutex);
+	s_Released.push_back({ type, rendererID });
+}
+
+void DeletionQueue::EndFrame() {
+
+	std::vector<ReleasedObject> released;
+	{
+		std::lock_guard<std::mutex> lock(s_ReleaseMutex);
+		released.swap(s_Released);
+	}
+
+	if (!released.empty()) {
+		ReleasedBatch batch;
+		GLCall(batch.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		batch.Objects = std::move(released);
+		s_Batches.push_back(std::move(batch));
+	}
+
+	while (!s_Batches.empty()) {
+		// A timeout of 0 only checks the fence, it never waits.
+		GLenum result = glClientWaitSync(s_Batches.front().Fence, 0, 0);
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+			break;
+
+		DeleteBatch(s_Batches.front());
+		s_Batches.pop_front();
+	}
+}
+
+void DeletionQueue::Flush() {
+
+	GLCall(glFinish()); // every fence has signaled after this
+
+	std::vector<ReleasedObject> released;
+	{
+		std::lock_guard<std::mutex> lock(s_ReleaseMutex);
+		released.swap(s_Released);
+	}
+
+	for (ReleasedBatch& batch : s_Batches)
+		DeleteBatch(batch);
+	s_Batches.clear();
+
+	for (const ReleasedObject& object : released)
+		DeleteObject(object);
+}
+
+unsigned int DeletionQueue::GetPendingCount() {
+
+	unsigned int count = 0;
+	for (const ReleasedBatch& batch : s_Batches)
+		count += (unsigned int)batch.Objects.size();
+
+	std::lock_guard<std::mutex> lock(s_ReleaseMutex);
+	return count + (unsigned int)s_Released.size();
+}
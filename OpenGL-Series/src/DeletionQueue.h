@@ -0,0 +1,44 @@
+#pragma once
+
+
+enum class GLObjectType {
+
+	Buffer,
+	VertexArray,
+	Program,
+	Texture
+};
+
+// Notes regarding DeletionQueue
+/*
+	Calling glDelete*() the moment a C++ object dies is legal, but the GPU usually runs a frame or two behind the CPU, so it may still be reading the object.
+	The driver then has to either stall until the GPU is done or keep a hidden copy alive itself.
+
+	Instead, the wrapper classes hand their GL names to the DeletionQueue. Once per frame EndFrame() puts a glFenceSync() after all the draws that could still use
+	the objects released during that frame, and the objects are only deleted once that fence has signaled, i.e. when the GPU is provably done with them.
+	Fences signal in the order they were inserted, so only the oldest batches have to be checked.
+
+	Release() only takes a lock and appends to a list, so it can be called from any thread. Everything else (EndFrame()/Flush()) makes GL calls and has to 
+	run on the thread that owns the context.
+
+	That makes destroying these wrappers safe off the GL thread (e.g. a loader thread dropping a mesh): VertexArray, UniformBuffer, and VertexBuffer/
+	IndexBuffer that own their GL buffer. Not safe, destroy these on the GL thread:
+	- VertexBuffer/IndexBuffer living in a BufferArena, they give their range back to the arena's OffsetAllocator, which has no lock.
+	- StreamBuffer, it unmaps its buffer and deletes its fences directly.
+	- Shader, it also unregisters itself from hot reload.
+*/
+class DeletionQueue {
+
+public:
+
+	// Any thread (see the notes above for which wrappers that makes safe to destroy). The object must not be used again after this.
+	static void Release(GLObjectType type, unsigned int rendererID);
+
+	// GL thread, once per frame after the frame's draws: fences the objects released since the last call and deletes the ones whose fence has signaled.
+	static void EndFrame();
+
+	// GL thread: waits for the GPU and deletes everything still queued. Call before destroying the context.
+	static void Flush();
+
+	static unsigned int GetPendingCount();
+};
@@ -0,0 +1,52 @@
+#include "DirectStateAccess.h"
+
+#include <iostream>
+
+#include "Renderer.h"
+#include "GLState.h"
+
+
+bool DirectStateAccess::s_Enabled = false;
+
+
+void DirectStateAccess::Init(bool allow) {
+
+	s_Enabled = allow && (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access);
+	std::cout << "[OpenGL] " << (s_Enabled ? "Direct state access" : "Bind-to-edit (no direct state access)") << std::endl;
+}
+
+unsigned int DirectStateAccess::CreateBuffer(unsigned int target) {
+
+	unsigned int buffer = 0;
+	if (s_Enabled) {
+		GLCall(glCreateBuffers(1, &buffer));
+	}
+	else {
+		// glGenBuffers() only reserves a name, the object itself is created by the first bind.
+		GLCall(glGenBuffers(1, &buffer));
+		GLState::BindBuffer(target, buffer);
+	}
+	return buffer;
+}
+
+void DirectStateAccess::BufferData(unsigned int buffer, unsigned int target, unsigned int size, const void* data, unsigned int usage) {
+
+	if (s_Enabled) {
+		GLCall(glNamedBufferData(buffer, size, data, usage));
+		return;
+	}
+
+	GLState::BindBuffer(target, buffer);
+	GLCall(glBufferData(target, size, data, usage));
+}
+
+void DirectStateAccess::BufferSubData(unsigned int buffer, unsigned int target, unsigned int offset, unsigned int size, const void* data) {
+
+	if (s_Enabled) {
+		GLCall(glNamedBufferSubData(buffer, offset, size, data));
+		return;
+	}
+
+	GLState::BindBuffer(target, buffer);
+	GLCall(glBufferSubData(target, offset, size, data));
+}
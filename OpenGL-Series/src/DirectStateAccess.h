@@ -0,0 +1,33 @@
+#pragma once
+
+
+// Notes regarding DirectStateAccess
+/*
+	Classic GL edits objects through bind points: to fill a buffer it has to be bound to some target first, to set up a VAO it has to be bound, to set a
+	uniform the program has to be in use. Every edit costs extra bind calls and leaves different objects bound than before (which is why IndexBuffer uploads
+	go through GL_COPY_WRITE_BUFFER, binding GL_ELEMENT_ARRAY_BUFFER would change the bound VAO).
+
+	GL 4.5 (or ARB_direct_state_access) adds functions that take the object name directly: glNamedBufferData(), glVertexArrayAttribFormat(), 
+	glProgramUniform*()... Nothing gets bound, so edits don't disturb the state that draws rely on.
+
+	Init() checks the context once at startup. VertexBuffer, IndexBuffer, VertexArray, Shader, BufferArena and UniformBuffer then use the DSA functions when 
+	IsEnabled(), and the bind-to-edit path otherwise. The buffer helpers below hide the difference for the simple cases, 'target' is the bind point the
+	fallback uses.
+*/
+class DirectStateAccess {
+
+private:
+
+	static bool s_Enabled;
+
+public:
+
+	// Call once after glewInit(). 'allow' = false forces the bind-to-edit path, e.g. to compare the two.
+	static void Init(bool allow = true);
+	inline static bool IsEnabled() { return s_Enabled; }
+
+	// glCreateBuffers(), or glGenBuffers() + a first bind to 'target' so the object exists.
+	static unsigned int CreateBuffer(unsigned int target);
+	static void BufferData(unsigned int buffer, unsigned int target, unsigned int size, const void* data, unsigned int usage);
+	static void BufferSubData(unsigned int buffer, unsigned int target, unsigned int offset, unsigned int size, const void* data);
+};
@@ -0,0 +1,140 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+static std::filesystem::file_time_type GetWriteTime(const std::string& path) {
+
+	std::error_code error;
+	std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+	return error ? std::filesystem::file_time_type() : time;
+}
+
+FileWatcher::FileWatcher() 
+	: m_Running(true), m_NotifyFD(-1)
+{
+#ifdef __linux__
+	m_NotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	m_Thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher() {
+
+	// Both loops wake up at least every 100 ms to check this.
+	m_Running = false;
+	m_Thread.join();
+
+#ifdef __linux__
+	if (m_NotifyFD != -1)
+		close(m_NotifyFD);
+#endif
+}
+
+std::string FileWatcher::Normalise(const std::string& path) {
+
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+void FileWatcher::Watch(const std::string& path) {
+
+	const std::string file = Normalise(path);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Files.count(file))
+		return;
+	m_Files[file] = GetWriteTime(file);
+
+#ifdef __linux__
+	if (m_NotifyFD != -1) {
+		std::string directory = std::filesystem::path(file).parent_path().generic_string();
+		if (directory.empty())
+			directory = ".";
+
+		// Adding the same directory again returns the descriptor it already has. Only events that mean the file is complete: a file written in place is
+		// closed, a file written elsewhere is renamed into place. IN_CREATE would fire for a new, still empty file on delete-and-recreate saves.
+		int descriptor = inotify_add_watch(m_NotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (descriptor != -1)
+			m_Directories[descriptor] = directory;
+	}
+#endif
+}
+
+std::vector<FileChange> FileWatcher::PollChanges() {
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	std::vector<FileChange> changes;
+	changes.swap(m_Changes);
+	return changes;
+}
+
+void FileWatcher::QueueChange(const std::string& path) {
+
+	// Called with m_Mutex held.
+	auto queued = std::find_if(m_Changes.begin(), m_Changes.end(), [&](const FileChange& change) { return change.Path == path; });
+	if (queued == m_Changes.end())
+		m_Changes.push_back({ path, std::chrono::steady_clock::now() });
+}
+
+void FileWatcher::Run() {
+
+	if (m_NotifyFD != -1)
+		RunNotify();
+	else
+		RunPolling();
+}
+
+void FileWatcher::RunNotify() {
+
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+
+	while (m_Running) {
+
+		pollfd descriptor = { m_NotifyFD, POLLIN, 0 };
+		if (poll(&descriptor, 1, 100) <= 0)
+			continue;
+
+		ssize_t length;
+		while ((length = read(m_NotifyFD, buffer, sizeof(buffer))) > 0) {
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(inotify_event) + ((inotify_event*)ptr)->len) {
+
+				const inotify_event* event = (const inotify_event*)ptr;
+				auto directory = m_Directories.find(event->wd);
+				if (event->len == 0 || directory == m_Directories.end())
+					continue;
+
+				// Everything in the directory shows up here, only the files that were asked for are queued.
+				const std::string file = Normalise(directory->second + '/' + event->name);
+				if (m_Files.count(file))
+					QueueChange(file);
+			}
+		}
+	}
+#endif
+}
+
+void FileWatcher::RunPolling() {
+
+	while (m_Running) {
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (auto& [file, lastWrite] : m_Files) {
+			std::filesystem::file_time_type time = GetWriteTime(file);
+			if (time != lastWrite) {
+				lastWrite = time;
+				QueueChange(file);
+			}
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+// A watched file that was written to, with the time the watcher noticed it. That is right after the write with inotify, up to 100 ms later when polling.
+struct FileChange {
+
+	std::string Path;
+	std::chrono::steady_clock::time_point DetectedAt;
+};
+
+// Notes regarding FileWatcher
+/*
+	Watches a set of files from a background thread and queues the ones that changed, PollChanges() hands them to whoever wants to react to them (e.g. 
+	Shader::ProcessHotReload() on the GL thread).
+
+	On Linux the thread sleeps in inotify and wakes up the moment a file is written. It watches the directory rather than the file: most editors save by 
+	writing a new file and renaming it over the old one, which would silently drop a watch on the file itself. Elsewhere the thread compares the last write 
+	time of every watched file a few times a second.
+
+	A file that changes several times before PollChanges() is queued once, so a save that produces a burst of events causes a single reload.
+*/
+class FileWatcher {
+
+private:
+
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+
+	std::mutex m_Mutex;
+	std::unordered_map<std::string, std::filesystem::file_time_type> m_Files; // watched paths (normalised) -> last write time seen, for the polling path
+	std::unordered_map<int, std::string> m_Directories; // inotify watch descriptor -> directory
+	std::vector<FileChange> m_Changes;
+
+	int m_NotifyFD; // -1 when polling
+
+public:
+
+	FileWatcher();
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	// Any thread. Watching the same file twice does nothing.
+	void Watch(const std::string& path);
+
+	// Any thread. Takes the changes queued since the last call, oldest first.
+	std::vector<FileChange> PollChanges();
+
+	inline bool IsNative() const { return m_NotifyFD != -1; }
+
+	static std::string Normalise(const std::string& path);
+
+private:
+
+	void Run();
+	void RunNotify();
+	void RunPolling();
+	void QueueChange(const std::string& path);
+};
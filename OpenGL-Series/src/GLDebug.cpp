@@ -0,0 +1,139 @@
+#include "GLDebug.h"
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+
+static std::atomic<const GLCallSite*> s_CurrentCall(nullptr); // written by the GL thread, read by the driver's callback thread in asynchronous mode
+static std::atomic<bool> s_CallbackActive(false);
+static std::atomic<bool> s_BreakOnError(false);
+
+static std::mutex s_ErrorMutex;
+static std::unordered_map<const GLCallSite*, unsigned int> s_ErrorCounts;
+
+
+void GLClearError() {
+
+	// Clears all the errors from OpenGL.
+	// glGetError only returns 1 error at once, from a list of errors, thus in order to know what the errors are, you have to loop through, until GL_NO_ERROR is returned. 
+	while (glGetError() != GL_NO_ERROR);
+}
+
+void GLBeginCall(const GLCallSite* site) {
+
+	s_CurrentCall.store(site, std::memory_order_relaxed);
+
+	if (!s_CallbackActive.load(std::memory_order_relaxed))
+		GLClearError();
+}
+
+bool GLEndCall() {
+
+	// The callback reports errors by itself, nothing to poll.
+	if (s_CallbackActive.load(std::memory_order_relaxed))
+		return true;
+
+	bool ok = true;
+	while (GLenum error = glGetError()) {
+		GLDebug::RecordError(s_CurrentCall.load(std::memory_order_relaxed), error, 0, nullptr);
+		ok = false;
+	}
+	return ok || !s_BreakOnError.load(std::memory_order_relaxed);
+}
+
+static void GLAPIENTRY OnDebugMessage(GLenum /*source*/, GLenum type, GLuint id, GLenum severity, GLsizei /*length*/, const GLchar* message, 
+	const void* /*userParam*/) {
+
+	// Notifications are things like "buffer will use video memory", not worth reporting.
+	if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+		return;
+
+	if (type == GL_DEBUG_TYPE_ERROR) {
+		GLDebug::RecordError(s_CurrentCall.load(std::memory_order_relaxed), 0, id, message);
+
+		// Only useful in synchronous mode, where this runs on the GL thread inside the offending call.
+		if (s_BreakOnError.load(std::memory_order_relaxed))
+			DEBUG_BREAK();
+		return;
+	}
+
+	// Performance/deprecation warnings etc.
+	std::cout << "[OpenGL Debug] (" << id << "): " << message << std::endl;
+}
+
+bool GLDebug::Init(bool synchronous) {
+
+	// glDebugMessageCallback is core in 4.3, KHR_debug exposes the same entry points on older contexts.
+	if (!(GLEW_VERSION_4_3 || GLEW_KHR_debug) || glDebugMessageCallback == nullptr)
+		return false;
+
+	glEnable(GL_DEBUG_OUTPUT);
+	if (synchronous)
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	else
+		glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+	glDebugMessageCallback(OnDebugMessage, nullptr);
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+
+	s_CallbackActive = true;
+	return true;
+}
+
+bool GLDebug::IsCallbackActive() { return s_CallbackActive; }
+
+void GLDebug::SetBreakOnError(bool breakOnError) { s_BreakOnError = breakOnError; }
+bool GLDebug::GetBreakOnError() { return s_BreakOnError; }
+
+void GLDebug::RecordError(const GLCallSite* site, unsigned int error, unsigned int messageID, const char* message) {
+
+	std::lock_guard<std::mutex> lock(s_ErrorMutex);
+
+	// Only the first error of every call site is printed, a broken call inside the render loop would otherwise flood the console every frame.
+	if (s_ErrorCounts[site]++ > 0)
+		return;
+
+	if (error != 0)
+		std::cout << "[OpenGL Error] (0x" << std::hex << error << std::dec << "): ";
+	else
+		std::cout << "[OpenGL Error] (debug message " << messageID << "): ";
+	if (site)
+		std::cout << site->Function << " " << site->File << ": " << site->Line;
+	else
+		std::cout << "<unknown call site>";
+	if (message)
+		std::cout << " - " << message;
+	std::cout << std::endl;
+}
+
+std::vector<GLCallSiteErrors> GLDebug::GetErrorCounts() {
+
+	std::lock_guard<std::mutex> lock(s_ErrorMutex);
+
+	std::vector<GLCallSiteErrors> counts;
+	counts.reserve(s_ErrorCounts.size());
+	for (const auto& entry : s_ErrorCounts)
+		counts.push_back({ entry.first, entry.second });
+	return counts;
+}
+
+void GLDebug::PrintReport() {
+
+	std::vector<GLCallSiteErrors> counts = GetErrorCounts();
+	if (counts.empty())
+		return;
+
+	std::cout << "[OpenGL Error Report]" << std::endl;
+	for (const GLCallSiteErrors& entry : counts) {
+		std::cout << "  " << entry.Count << "x ";
+		if (entry.Site)
+			std::cout << entry.Site->Function << " " << entry.Site->File << ": " << entry.Site->Line;
+		else
+			std::cout << "<unknown call site>";
+		std::cout << std::endl;
+	}
+}
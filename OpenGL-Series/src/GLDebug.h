@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+
+// Build switch for the per-call error checking. Defaults to on in debug builds and off in release builds (NDEBUG), but can be forced either way by defining
+// GL_CALL_CHECKS=0/1 in the project's preprocessor definitions.
+#ifndef GL_CALL_CHECKS
+	#ifdef NDEBUG
+		#define GL_CALL_CHECKS 0
+	#else
+		#define GL_CALL_CHECKS 1
+	#endif
+#endif
+
+// MSVC specific function. __ means that its compiler intrinsic. This essentially inserts a breakpoint whenver an error is encountered. 
+#if defined(_MSC_VER)
+	#define DEBUG_BREAK() __debugbreak()
+#else
+	#define DEBUG_BREAK() __builtin_trap()
+#endif
+
+// Describes one GLCall() in the source code. Every GLCall() owns a static one of these, so a call site can be identified by its address.
+struct GLCallSite {
+
+	const char* Function;
+	const char* File;
+	int Line;
+};
+
+#if GL_CALL_CHECKS
+	#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+	#define GLCall(x) GLBeginCall([]() { static const GLCallSite site = { #x, __FILE__, __LINE__ }; return &site; }());\
+					x;\
+					ASSERT(GLEndCall())
+					//'#x' converts x into a string // __FILE__ and __LINE__ is supported by all compilers, unlike __debugbreak(), which is only for MSVCs
+#else
+	// Release builds: no glGetError() round trips at all, GLCall() is just the call. Errors can still be collected through GLDebug::Init().
+	#define ASSERT(x)
+	#define GLCall(x) x
+#endif
+
+void GLClearError();
+void GLBeginCall(const GLCallSite* site);
+bool GLEndCall();
+
+
+struct GLCallSiteErrors {
+
+	const GLCallSite* Site; // nullptr for errors that couldn't be tied to a GLCall() (e.g. GL_CALL_CHECKS=0)
+	unsigned int Count;
+};
+
+// Notes regarding GLDebug
+/*
+	glGetError() is a round trip to the driver, and on a lot of drivers it forces the CPU to wait for the GPU to catch up. Doing it twice per GLCall() (once to
+	clear, once to check) is what made debug builds so slow.
+
+	GL 4.3 (or the KHR_debug extension) lets the driver call us instead, through glDebugMessageCallback(). Once GLDebug::Init() has installed the callback, 
+	GLCall() only records which call site is currently executing (one pointer store) and the errors are counted per call site when the driver reports them.
+
+	In asynchronous mode the driver may report an error some time after the call that caused it, from its own thread, so the call site an error is counted 
+	against is the most recent GLCall() at that point (close, but not exact). Synchronous mode makes the attribution exact and lets a breakpoint land on the
+	offending call, at the cost of the driver no longer running ahead of us.
+
+	Without KHR_debug GLCall() falls back to polling glGetError(), counting into the same per call site table.
+*/
+class GLDebug {
+
+public:
+
+	// Installs the debug message callback. Returns false if the context doesn't support it (GLCall() then keeps using glGetError()). Needs a debug context
+	// (GLFW_OPENGL_DEBUG_CONTEXT) on most drivers to report anything.
+	static bool Init(bool synchronous);
+	static bool IsCallbackActive();
+
+	// Off by default, errors are only counted and the first error of each call site is printed.
+	static void SetBreakOnError(bool breakOnError);
+	static bool GetBreakOnError();
+
+	// 'error' is a glGetError() value, 0 for errors reported through the callback. Those carry the driver's message ID instead, which is driver-specific
+	// and not a GL error enum, so the two are kept apart.
+	static void RecordError(const GLCallSite* site, unsigned int error, unsigned int messageID, const char* message);
+
+	static std::vector<GLCallSiteErrors> GetErrorCounts();
+	static void PrintReport();
+};
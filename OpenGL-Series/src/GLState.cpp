@@ -0,0 +1,152 @@
+#include "GLState.h"
+
+#include "Renderer.h"
+
+
+// ~0 is never handed out as an object name, so it is used as "unknown", which makes the first bind after startup/Invalidate() always reach the driver.
+static const unsigned int s_Unknown = ~0u;
+
+unsigned int GLState::s_Program = s_Unknown;
+unsigned int GLState::s_VertexArray = s_Unknown;
+unsigned int GLState::s_Buffers[GLState::BufferSlotCount] = { s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown, s_Unknown };
+GLState::IndexedBinding GLState::s_UniformBindings[GLState::MaxUniformBindings];
+GLStateStats GLState::s_Stats;
+
+
+void GLState::UseProgram(unsigned int program) {
+
+	if (s_Program == program) {
+		s_Stats.SkippedCalls++;
+		return;
+	}
+
+	GLCall(glUseProgram(program));
+	s_Program = program;
+	s_Stats.IssuedCalls++;
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray) {
+
+	if (s_VertexArray == vertexArray) {
+		s_Stats.SkippedCalls++;
+		return;
+	}
+
+	GLCall(glBindVertexArray(vertexArray));
+	s_VertexArray = vertexArray;
+	s_Buffers[ElementArrayBuffer] = s_Unknown; // every VAO has its own IBO binding
+	s_Stats.IssuedCalls++;
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer) {
+
+	int slot = GetBufferSlot(target);
+
+	// Targets that aren't tracked are always passed through.
+	if (slot >= 0 && s_Buffers[slot] == buffer) {
+		s_Stats.SkippedCalls++;
+		return;
+	}
+
+	GLCall(glBindBuffer(target, buffer));
+	if (slot >= 0)
+		s_Buffers[slot] = buffer;
+	s_Stats.IssuedCalls++;
+}
+
+void GLState::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) {
+
+	BindIndexed(target, index, { buffer, 0, 0 });
+}
+
+void GLState::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, intptr_t offset, intptr_t size) {
+
+	BindIndexed(target, index, { buffer, offset, size });
+}
+
+void GLState::BindIndexed(unsigned int target, unsigned int index, const IndexedBinding& binding) {
+
+	// Only uniform buffer binding points are tracked, other targets (transform feedback, SSBOs...) are always passed through.
+	const bool tracked = target == GL_UNIFORM_BUFFER && index < MaxUniformBindings;
+	if (tracked) {
+		const IndexedBinding& bound = s_UniformBindings[index];
+		if (bound.Buffer == binding.Buffer && bound.Offset == binding.Offset && bound.Size == binding.Size) {
+			s_Stats.SkippedCalls++;
+			return;
+		}
+	}
+
+	if (binding.Size == 0) {
+		GLCall(glBindBufferBase(target, index, binding.Buffer));
+	}
+	else {
+		GLCall(glBindBufferRange(target, index, binding.Buffer, binding.Offset, binding.Size));
+	}
+
+	if (tracked)
+		s_UniformBindings[index] = binding;
+
+	// Indexed binds also bind the buffer to the generic binding point of the target.
+	int slot = GetBufferSlot(target);
+	if (slot >= 0)
+		s_Buffers[slot] = binding.Buffer;
+	s_Stats.IssuedCalls++;
+}
+
+void GLState::OnProgramDeleted(unsigned int program) {
+
+	if (s_Program == program)
+		s_Program = s_Unknown;
+}
+
+void GLState::OnVertexArrayDeleted(unsigned int vertexArray) {
+
+	// Deleting the bound VAO makes GL fall back to VAO 0.
+	if (s_VertexArray == vertexArray) {
+		s_VertexArray = 0;
+		s_Buffers[ElementArrayBuffer] = s_Unknown;
+	}
+}
+
+void GLState::OnBufferDeleted(unsigned int buffer) {
+
+	// Deleting a bound buffer makes GL reset that binding to 0.
+	for (unsigned int& bound : s_Buffers) {
+		if (bound == buffer)
+			bound = 0;
+	}
+	for (IndexedBinding& bound : s_UniformBindings) {
+		if (bound.Buffer == buffer)
+			bound = { 0, 0, 0 };
+	}
+}
+
+void GLState::Invalidate() {
+
+	s_Program = s_Unknown;
+	s_VertexArray = s_Unknown;
+	for (unsigned int& bound : s_Buffers)
+		bound = s_Unknown;
+	for (IndexedBinding& bound : s_UniformBindings)
+		bound = { s_Unknown, 0, 0 };
+}
+
+void GLState::ResetStats() {
+
+	s_Stats = GLStateStats();
+}
+
+int GLState::GetBufferSlot(unsigned int target) {
+
+	switch (target) {
+		case GL_ARRAY_BUFFER:         return ArrayBuffer;
+		case GL_ELEMENT_ARRAY_BUFFER: return ElementArrayBuffer;
+		case GL_UNIFORM_BUFFER:       return UniformBuffer;
+		case GL_COPY_READ_BUFFER:     return CopyReadBuffer;
+		case GL_COPY_WRITE_BUFFER:    return CopyWriteBuffer;
+		case GL_DRAW_INDIRECT_BUFFER: return DrawIndirectBuffer;
+		case GL_PIXEL_PACK_BUFFER:    return PixelPackBuffer;
+		case GL_PIXEL_UNPACK_BUFFER:  return PixelUnpackBuffer;
+	}
+	return -1;
+}
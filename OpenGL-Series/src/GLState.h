@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Counts of the bind calls that went through GLState, reset with GLState::ResetStats().
+struct GLStateStats {
+
+	unsigned int IssuedCalls = 0;  // binds that actually reached the driver
+	unsigned int SkippedCalls = 0; // binds that were dropped because the object was already bound
+};
+
+// Notes regarding GLState
+/*
+	OpenGL is a state machine, binding an object that is already bound is legal but it still costs a call into the driver. GLState remembers what is currently
+	bound (program, VAO and one buffer per target) and skips the call when nothing would change.
+
+	For this to work EVERY bind has to go through GLState, a raw glBindBuffer()/glUseProgram()/glBindVertexArray() somewhere else makes the cache lie. If some 
+	code has to touch the state directly, call GLState::Invalidate() afterwards.
+
+	The element array (IBO) binding is part of the VAO state, not global state, so it is forgotten whenever the bound VAO changes.
+
+	Indexed uniform buffer bindings (glBindBufferBase()/glBindBufferRange()) are tracked per binding point as well. Both calls also change the generic
+	GL_UNIFORM_BUFFER binding, which the cache accounts for.
+*/
+class GLState {
+
+private:
+
+	enum BufferSlot {
+		ArrayBuffer = 0, ElementArrayBuffer, UniformBuffer, CopyReadBuffer, CopyWriteBuffer, DrawIndirectBuffer, PixelPackBuffer, PixelUnpackBuffer,
+		BufferSlotCount
+	};
+
+	// A whole buffer bound with glBindBufferBase() is stored with Size 0.
+	struct IndexedBinding {
+
+		unsigned int Buffer;
+		intptr_t Offset;
+		intptr_t Size;
+	};
+
+	static const unsigned int MaxUniformBindings = 36; // GL_MAX_UNIFORM_BUFFER_BINDINGS is at least 36 on GL 3.3
+
+	static unsigned int s_Program;
+	static unsigned int s_VertexArray;
+	static unsigned int s_Buffers[BufferSlotCount];
+	static IndexedBinding s_UniformBindings[MaxUniformBindings];
+	static GLStateStats s_Stats;
+
+public:
+
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertexArray);
+	static void BindBuffer(unsigned int target, unsigned int buffer);
+	static void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+	static void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, intptr_t offset, intptr_t size);
+
+	// GL hands out deleted names again, so the cache has to forget an object once it has been deleted.
+	static void OnProgramDeleted(unsigned int program);
+	static void OnVertexArrayDeleted(unsigned int vertexArray);
+	static void OnBufferDeleted(unsigned int buffer);
+
+	// Forgets everything, the next bind of each kind always reaches the driver.
+	static void Invalidate();
+
+	inline static const GLStateStats& GetStats() { return s_Stats; }
+	static void ResetStats();
+
+private:
+
+	static int GetBufferSlot(unsigned int target);
+	static void BindIndexed(unsigned int target, unsigned int index, const IndexedBinding& binding);
+};
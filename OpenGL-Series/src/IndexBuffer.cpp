@@ -1,23 +1,142 @@
 #include "IndexBuffer.h"
 
+#include <iostream>
+#include <utility>
+
 #include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "DirectStateAccess.h"
 
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count) 
-	: m_Count(count)
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage) 
+	: m_Count(count), m_Arena(nullptr), m_Usage(usage)
 {
 	
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID)); // this is specifying that this buffer object will be used for element indices during drawing operations. 
+	// Without DSA this binds to GL_ELEMENT_ARRAY_BUFFER, which specifies that this buffer object will be used for element indices during drawing operations. 
+	m_RendererID = DirectStateAccess::CreateBuffer(GL_ELEMENT_ARRAY_BUFFER);
 	// [below] Creates and initialises a buffer object's data store // Uploading index data from CPU RAM to GPU's VRAM. 
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	DirectStateAccess::BufferData(m_RendererID, GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GetGLUsage(m_Usage));
+	m_View = { m_RendererID, 0, count * (unsigned int)sizeof(unsigned int), 0 };
+}
+
+IndexBuffer::IndexBuffer(BufferArena& arena, const unsigned int* data, unsigned int count) 
+	: m_Count(count), m_Arena(&arena), m_View(arena.Allocate(count * sizeof(unsigned int), sizeof(unsigned int))), m_Usage(BufferUsage::Static)
+{
+	m_RendererID = m_View.RendererID;
+	if (data)
+		m_Arena->Upload(m_View, data, count * sizeof(unsigned int));
+}
+
+IndexBuffer::~IndexBuffer() { Release(); }
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Count(other.m_Count), m_Arena(other.m_Arena), m_View(other.m_View), m_Usage(other.m_Usage), 
+	  m_Shadow(std::move(other.m_Shadow))
+{
+	other.m_RendererID = 0;
+	other.m_Count = 0;
+	other.m_Arena = nullptr;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept {
+
+	if (this != &other) {
+		Release();
+
+		m_RendererID = other.m_RendererID;
+		m_Count = other.m_Count;
+		m_Arena = other.m_Arena;
+		m_View = other.m_View;
+		m_Usage = other.m_Usage;
+		m_Shadow = std::move(other.m_Shadow);
+
+		other.m_RendererID = 0;
+		other.m_Count = 0;
+		other.m_Arena = nullptr;
+	}
+	return *this;
+}
+
+void IndexBuffer::Release() {
+
+	if (m_RendererID == 0)
+		return;
+
+	// The arena owns the GL buffer, only the range is given back.
+	if (m_Arena) {
+		m_Arena->Free(m_View);
+	}
+	else {
+		DeletionQueue::Release(GLObjectType::Buffer, m_RendererID); // deleted once the GPU is done with it
+	}
+	m_RendererID = 0;
+	m_Arena = nullptr;
+}
+
+bool IndexBuffer::SetData(const unsigned int* data, unsigned int count) {
+
+	// Checked in release builds too, the bytes past the view belong to the neighbouring meshes of the arena.
+	if (m_Arena && count * sizeof(unsigned int) > m_View.Size) {
+		std::cout << "[IndexBuffer] SetData() of " << count << " indices doesn't fit into the arena view of " << m_View.Size / sizeof(unsigned int) 
+			<< " indices, ignored." << std::endl;
+		return false;
+	}
+
+	m_Shadow.Clear(); // anything still pending is overwritten anyway
+	m_Count = count;
+
+	if (m_Arena) {
+		m_Arena->Upload(m_View, data, count * sizeof(unsigned int));
+		return true;
+	}
+
+	// Without DSA this goes through GL_COPY_WRITE_BUFFER, binding GL_ELEMENT_ARRAY_BUFFER would change the IBO of whatever VAO is bound.
+	DirectStateAccess::BufferData(m_RendererID, GL_COPY_WRITE_BUFFER, count * sizeof(unsigned int), data, GetGLUsage(m_Usage));
+	m_View.Size = count * sizeof(unsigned int);
+	return true;
 }
 
-IndexBuffer::~IndexBuffer() {	GLCall(glDeleteBuffers(1, &m_RendererID)); }
+void IndexBuffer::SetSubData(const unsigned int* data, unsigned int count, unsigned int first) {
+
+	// Checked in release builds too, for an arena view the indices past it belong to the neighbouring meshes.
+	const unsigned int capacity = m_View.Size / sizeof(unsigned int);
+	if (count > capacity || first > capacity - count) { // written so it can't wrap around
+		std::cout << "[IndexBuffer] SetSubData() of " << count << " indices at index " << first << " is past the end of the " 
+			<< capacity << " index buffer, ignored." << std::endl;
+		return;
+	}
+	m_Shadow.Write(first * sizeof(unsigned int), data, count * sizeof(unsigned int));
+}
+
+void IndexBuffer::Flush() {
+
+	if (!m_Shadow.IsDirty())
+		return;
+
+	// Every byte was rewritten: orphan instead of patching, so the upload never has to wait for draws still reading the old contents.
+	if (!m_Arena && m_Shadow.CoversWholeBuffer(m_View.Size)) {
+		DirectStateAccess::BufferData(m_RendererID, GL_COPY_WRITE_BUFFER, m_View.Size, m_Shadow.GetData(), GetGLUsage(m_Usage));
+		m_Shadow.Clear();
+		return;
+	}
+
+	for (const DirtyRange& range : m_Shadow.GetDirtyRanges()) {
+		if (m_Arena) {
+			m_Arena->Upload(m_View, m_Shadow.GetData() + range.Begin, range.End - range.Begin, range.Begin);
+		}
+		else {
+			DirectStateAccess::BufferSubData(m_RendererID, GL_COPY_WRITE_BUFFER, range.Begin, range.End - range.Begin, m_Shadow.GetData() + range.Begin);
+		}
+	}
+	m_Shadow.Clear();
+}
 
-void IndexBuffer::Bind() const { GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID)); }
+void IndexBuffer::Bind() const { GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID); }
 
-void IndexBuffer::Unbind() const { GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0)); }
+#ifndef NDEBUG
+void IndexBuffer::Unbind() const { GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
+#endif
 
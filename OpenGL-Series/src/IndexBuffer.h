@@ -1,20 +1,58 @@
 #pragma once
 
+#include "BufferArena.h"
+#include "BufferShadow.h"
+
+
 class IndexBuffer {
 
 private:
 
 	unsigned int m_RendererID; // Refer to EP13-15 Notes for naming reasoning of "m_RendererID"
 	unsigned int m_Count;
+	BufferArena* m_Arena;      // nullptr if the buffer owns m_RendererID, otherwise the indices are the range m_View inside one of the arena's buffers
+	BufferView m_View;
+	BufferUsage m_Usage;
+	BufferShadow m_Shadow;     // pending SetSubData() writes, uploaded by Flush()
 
 public:
 
-	IndexBuffer(const unsigned int* data, unsigned int count);
+	IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage = BufferUsage::Static);
+	// Places the indices inside a shared buffer of the arena instead of creating a buffer of its own.
+	IndexBuffer(BufferArena& arena, const unsigned int* data, unsigned int count);
 	~IndexBuffer();
 
+	// Move-only, see VertexBuffer.
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
+	// Replaces all indices right away (orphaning the old storage), the index count becomes 'count'. Buffers living in an arena can't grow past their view,
+	// if 'count' doesn't fit nothing changes and it returns false.
+	bool SetData(const unsigned int* data, unsigned int count);
+	// Overwrites 'count' indices starting at index 'first'. The write is only recorded, nothing reaches the GPU until Flush(). A range past the end of the
+	// buffer is logged and ignored.
+	void SetSubData(const unsigned int* data, unsigned int count, unsigned int first);
+	// Uploads the indices changed by SetSubData() since the last Flush(), one glBufferSubData() per merged range. Has to be called before drawing.
+	void Flush();
+
 	void Bind() const;
+
+	// Debug builds only, same as VertexBuffer::Unbind().
+#ifdef NDEBUG
+	inline void Unbind() const {}
+#else
 	void Unbind() const;
+#endif
 
 	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetOffset() const { return m_View.Offset; } // in bytes, 0 unless the buffer lives in an arena
+	inline unsigned int GetFirstIndex() const { return m_View.Offset / sizeof(unsigned int); }
+
+private:
+
+	void Release();
 };
 
@@ -0,0 +1,69 @@
+#include "IndirectDrawBuffer.h"
+
+#include <cstdint>
+
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+
+
+IndirectDrawBuffer::IndirectDrawBuffer()
+	: m_RendererID(0), m_Capacity(0)
+{
+	if (IsSupported()) {
+		GLCall(glGenBuffers(1, &m_RendererID));
+	}
+}
+
+IndirectDrawBuffer::~IndirectDrawBuffer() {
+
+	DeletionQueue::Release(GLObjectType::Buffer, m_RendererID);
+}
+
+void IndirectDrawBuffer::Add(const MeshRange& mesh, unsigned int instanceCount, unsigned int baseInstance) {
+
+	m_Commands.push_back({ mesh.IndexCount, instanceCount, mesh.FirstIndex, mesh.BaseVertex, baseInstance });
+}
+
+void IndirectDrawBuffer::Clear() {
+
+	m_Commands.clear();
+}
+
+void IndirectDrawBuffer::Upload() {
+
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+
+	const unsigned int count = (unsigned int)m_Commands.size();
+	if (count > m_Capacity) {
+		// Grows to the next power of two, so a list that grows a bit every frame doesn't reallocate the GL buffer every frame.
+		while (m_Capacity < count)
+			m_Capacity = m_Capacity ? m_Capacity * 2 : 64;
+		GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW));
+	}
+
+	GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count * sizeof(DrawElementsIndirectCommand), m_Commands.data()));
+}
+
+bool IndirectDrawBuffer::BuildFallbackArrays() {
+
+	m_Counts.clear();
+	m_IndexOffsets.clear();
+	m_BaseVertices.clear();
+
+	bool singleInstance = true;
+	for (const DrawElementsIndirectCommand& command : m_Commands) {
+		m_Counts.push_back((int)command.Count);
+		m_IndexOffsets.push_back((void*)(uintptr_t)(command.FirstIndex * sizeof(unsigned int))); // glMultiDrawElementsBaseVertex() wants byte offsets
+		m_BaseVertices.push_back(command.BaseVertex);
+
+		if (command.InstanceCount != 1)
+			singleInstance = false;
+	}
+	return singleInstance;
+}
+
+bool IndirectDrawBuffer::IsSupported() {
+
+	return GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+
+// The layout of this struct is fixed by the GL spec, glMultiDrawElementsIndirect() reads it straight out of the GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand {
+
+	unsigned int Count;         // number of indices
+	unsigned int InstanceCount;
+	unsigned int FirstIndex;    // in indices, not bytes
+	int BaseVertex;             // added to every index before the vertex is fetched
+	unsigned int BaseInstance;
+};
+
+// Where one mesh lives inside a vertex/index buffer shared with other meshes. The indices of each mesh start at 0, BaseVertex moves them to the mesh's vertices.
+struct MeshRange {
+
+	unsigned int IndexCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+};
+
+// Notes regarding IndirectDrawBuffer
+/*
+	A list of draws of meshes that share one VertexArray, IndexBuffer and Shader, executed with Renderer::DrawIndirect(). Instead of one glDrawElements() per 
+	mesh (and the validation the driver does for each of them), the whole list becomes one glMultiDrawElementsIndirect() call (GL 4.3 / ARB_multi_draw_indirect)
+	that reads the draws from a GL buffer.
+
+	On GL 3.3 contexts the same list is executed with glMultiDrawElementsBaseVertex() from client memory, which is still a single call. Draws with more than one
+	instance fall back to one glDrawElementsInstancedBaseVertex() each, and BaseInstance is ignored since 3.3 has no way to set it.
+*/
+class IndirectDrawBuffer {
+
+private:
+
+	unsigned int m_RendererID; // 0 if the context has no multi draw indirect
+	unsigned int m_Capacity;   // how many commands the GL buffer currently has room for
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+
+	// Arrays for the glMultiDrawElementsBaseVertex() fallback, kept as members so they don't get reallocated every frame.
+	std::vector<int> m_Counts;
+	std::vector<void*> m_IndexOffsets;
+	std::vector<int> m_BaseVertices;
+
+public:
+
+	IndirectDrawBuffer();
+	~IndirectDrawBuffer();
+
+	IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+	IndirectDrawBuffer& operator=(const IndirectDrawBuffer&) = delete;
+
+	void Add(const MeshRange& mesh, unsigned int instanceCount = 1, unsigned int baseInstance = 0);
+	void Clear();
+
+	// Binds the GL_DRAW_INDIRECT_BUFFER and uploads the commands added since the last Clear(). Called by Renderer::DrawIndirect().
+	void Upload();
+	// Fills the fallback arrays, returns false if a draw needs instancing, in which case the commands have to be drawn one by one.
+	bool BuildFallbackArrays();
+
+	inline const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return m_Commands; }
+
+	// Non-const pointers because that's what GLEW's prototype of glMultiDrawElementsBaseVertex() takes, GL doesn't write to them.
+	inline int* GetCounts() { return m_Counts.data(); }
+	inline void** GetIndexOffsets() { return m_IndexOffsets.data(); }
+	inline int* GetBaseVertices() { return m_BaseVertices.data(); }
+	inline unsigned int GetCommandCount() const { return (unsigned int)m_Commands.size(); }
+
+	static bool IsSupported();
+};
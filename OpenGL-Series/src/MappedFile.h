@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+// Notes regarding MappedFile
+/*
+	Maps a whole file read-only into memory (mmap() / MapViewOfFile()) instead of reading it through a stream. The file's pages come straight from the OS 
+	file cache, nothing is copied into a buffer first, and GetView() hands the contents out as a std::string_view that parsers can slice without allocating.
+
+	The view is only valid while the MappedFile exists. Keep the mapping short-lived: a file that is truncated by another process while it's mapped makes 
+	reads past the new end fault (SIGBUS on Linux), so map, parse, copy out what is needed and let it go.
+*/
+class MappedFile {
+
+private:
+
+	const char* m_Data;
+	size_t m_Size;
+	bool m_Open;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#endif
+
+public:
+
+	// Check IsOpen(), a file that doesn't exist or can't be read gives an empty view. An empty file is open with an empty view.
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	inline bool IsOpen() const { return m_Open; }
+	inline std::string_view GetView() const { return std::string_view(m_Data, m_Size); }
+	inline size_t GetSize() const { return m_Size; }
+};
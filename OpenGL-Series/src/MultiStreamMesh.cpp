@@ -0,0 +1,23 @@
+#include "MultiStreamMesh.h"
+
+
+static VertexBufferLayout PositionLayout(unsigned int components) {
+
+	VertexBufferLayout layout;
+	layout.Push<float>(components);
+	return layout;
+}
+
+MultiStreamMesh::MultiStreamMesh(const float* positions, unsigned int positionComponents, const void* attributes, const VertexBufferLayout& attributeLayout, 
+	unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+	: m_Positions(positions, vertexCount * positionComponents * sizeof(float)), m_Attributes(attributes, vertexCount * attributeLayout.GetStride()),
+	  m_Indices(indices, indexCount)
+{
+	const VertexBufferLayout positionLayout = PositionLayout(positionComponents);
+
+	// Location 0 for positions in both VAOs, so the same vertex shader input works for both.
+	m_VertexArray.AddBufferAt(0, m_Positions, positionLayout);
+	m_VertexArray.AddBufferAt(1, m_Attributes, attributeLayout);
+
+	m_PositionVertexArray.AddBufferAt(0, m_Positions, positionLayout);
+}
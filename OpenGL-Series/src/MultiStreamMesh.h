@@ -0,0 +1,47 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+
+
+// Notes regarding MultiStreamMesh
+/*
+	An interleaved mesh (position, normal, UV, ... one vertex after the other) forces every pass to fetch every attribute, because they share cache lines.
+	A depth prepass or a shadow pass only needs positions, but still pulls normals, UVs and tangents through the memory bus, for big meshes that is most
+	of the bandwidth the pass uses.
+
+	Here the vertex data is split into two streams (structure of arrays instead of array of structures):
+
+		stream 0: positions only, tightly packed          -> location 0
+		stream 1: everything else, interleaved            -> locations 1, 2, ...
+
+	Two VAOs are built over the same buffers: the full one for normal passes, and a position-only one that never touches stream 1, for depth/shadow passes
+	(see Renderer::BeginDepthPass() and res/shaders/Depth.shader). Shaders for the full VAO read the position at location 0 and the other attributes from 1.
+*/
+class MultiStreamMesh {
+
+private:
+
+	VertexBuffer m_Positions;
+	VertexBuffer m_Attributes;
+	IndexBuffer m_Indices;
+	VertexArray m_VertexArray;
+	VertexArray m_PositionVertexArray;
+
+public:
+
+	// 'positions' holds 'positionComponents' floats per vertex, 'attributes' the rest of each vertex laid out as 'attributeLayout'.
+	MultiStreamMesh(const float* positions, unsigned int positionComponents, const void* attributes, const VertexBufferLayout& attributeLayout, 
+		unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+
+	MultiStreamMesh(const MultiStreamMesh&) = delete;
+	MultiStreamMesh& operator=(const MultiStreamMesh&) = delete;
+
+	// Every attribute, for the normal passes.
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	// Only the position stream, for depth and shadow passes.
+	inline const VertexArray& GetPositionVertexArray() const { return m_PositionVertexArray; }
+	inline const IndexBuffer& GetIndexBuffer() const { return m_Indices; }
+};
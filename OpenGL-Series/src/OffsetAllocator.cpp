@@ -0,0 +1,85 @@
+#include "OffsetAllocator.h"
+
+
+OffsetAllocator::OffsetAllocator(unsigned int size)
+	: m_Size(size), m_FreeSpace(0)
+{
+	InsertFreeRange(0, size);
+}
+
+unsigned int OffsetAllocator::Allocate(unsigned int size, unsigned int alignment) {
+
+	if (size == 0 || alignment == 0)
+		return InvalidOffset;
+
+	// The free ranges are visited from the smallest one that could fit, the first one that still fits after aligning is the best fit.
+	for (auto candidate = m_FreeBySize.lower_bound(size); candidate != m_FreeBySize.end(); ++candidate) {
+
+		const unsigned int rangeOffset = candidate->second;
+		const unsigned int rangeSize = candidate->first;
+
+		const unsigned int alignedOffset = (rangeOffset + alignment - 1) / alignment * alignment;
+		const unsigned int padding = alignedOffset - rangeOffset;
+		if (padding + size > rangeSize)
+			continue;
+
+		EraseFreeRange(m_FreeByOffset.find(rangeOffset));
+
+		// Whatever is left in front of (alignment) and behind the allocation stays free.
+		if (padding > 0)
+			InsertFreeRange(rangeOffset, padding);
+		if (padding + size < rangeSize)
+			InsertFreeRange(alignedOffset + size, rangeSize - padding - size);
+
+		return alignedOffset;
+	}
+
+	return InvalidOffset;
+}
+
+void OffsetAllocator::Free(unsigned int offset, unsigned int size) {
+
+	unsigned int start = offset;
+	unsigned int end = offset + size;
+
+	// Merges with the free range right after...
+	auto next = m_FreeByOffset.lower_bound(offset);
+	if (next != m_FreeByOffset.end() && next->first == end) {
+		end += next->second;
+		EraseFreeRange(next);
+	}
+
+	// ...and the one right before.
+	auto previous = m_FreeByOffset.lower_bound(offset);
+	if (previous != m_FreeByOffset.begin()) {
+		--previous;
+		if (previous->first + previous->second == start) {
+			start = previous->first;
+			EraseFreeRange(previous);
+		}
+	}
+
+	InsertFreeRange(start, end - start);
+}
+
+void OffsetAllocator::InsertFreeRange(unsigned int offset, unsigned int size) {
+
+	m_FreeByOffset[offset] = size;
+	m_FreeBySize.insert({ size, offset });
+	m_FreeSpace += size;
+}
+
+void OffsetAllocator::EraseFreeRange(std::map<unsigned int, unsigned int>::iterator range) {
+
+	// Several ranges can have the same size, so the one with the matching offset has to be searched for.
+	auto sized = m_FreeBySize.equal_range(range->second);
+	for (auto it = sized.first; it != sized.second; ++it) {
+		if (it->second == range->first) {
+			m_FreeBySize.erase(it);
+			break;
+		}
+	}
+
+	m_FreeSpace -= range->second;
+	m_FreeByOffset.erase(range);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+
+
+// Notes regarding OffsetAllocator
+/*
+	Hands out ranges [offset, offset + size) of a fixed size address space, without touching any memory itself. BufferArena uses it to place many small meshes
+	inside one big GL buffer.
+
+	Free ranges are kept twice: ordered by offset (to find the neighbours of a freed range, so touching free ranges are merged back into one and the space 
+	doesn't fragment into slivers), and ordered by size (to find the smallest free range a new allocation fits into, best fit).
+*/
+class OffsetAllocator {
+
+private:
+
+	std::map<unsigned int, unsigned int> m_FreeByOffset;    // offset -> size
+	std::multimap<unsigned int, unsigned int> m_FreeBySize; // size -> offset
+	unsigned int m_Size;
+	unsigned int m_FreeSpace;
+
+public:
+
+	static const unsigned int InvalidOffset = ~0u;
+
+	OffsetAllocator(unsigned int size);
+
+	// Returns InvalidOffset if there is no free range big enough. 'alignment' doesn't have to be a power of two (e.g. a vertex stride of 12 bytes).
+	unsigned int Allocate(unsigned int size, unsigned int alignment = 1);
+	// 'offset' and 'size' have to be the same as the ones the range was allocated with.
+	void Free(unsigned int offset, unsigned int size);
+
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetFreeSpace() const { return m_FreeSpace; }
+	inline unsigned int GetFreeRangeCount() const { return (unsigned int)m_FreeByOffset.size(); }
+
+private:
+
+	void InsertFreeRange(unsigned int offset, unsigned int size);
+	void EraseFreeRange(std::map<unsigned int, unsigned int>::iterator range);
+};
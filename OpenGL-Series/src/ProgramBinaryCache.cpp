@@ -0,0 +1,178 @@
+#include "ProgramBinaryCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Renderer.h"
+
+
+bool ProgramBinaryCache::s_Enabled = false;
+std::string ProgramBinaryCache::s_Directory;
+std::string ProgramBinaryCache::s_ContextID;
+unsigned int ProgramBinaryCache::s_Hits = 0;
+unsigned int ProgramBinaryCache::s_Misses = 0;
+
+
+// Written in front of every blob. The key is repeated so a file that doesn't belong to its name (or a hash collision) is never handed to the driver.
+struct ProgramBinaryHeader {
+
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t Key;
+	uint32_t Format;
+	uint32_t Length;
+};
+
+static constexpr uint32_t s_BinaryMagic = 0x42505347; // "GSPB"
+static constexpr uint32_t s_BinaryVersion = 1;
+
+// FNV-1a, 64 bit
+static inline void HashString(uint64_t& hash, const std::string& str) {
+
+	for (char c : str) {
+		hash ^= (unsigned char)c;
+		hash *= 0x100000001B3ull;
+	}
+	// Separator, so "ab" + "c" and "a" + "bc" don't hash the same.
+	hash ^= 0xFF;
+	hash *= 0x100000001B3ull;
+}
+
+static std::string GetString(unsigned int name) {
+
+	const char* str = (const char*)glGetString(name);
+	return str ? str : "";
+}
+
+void ProgramBinaryCache::Init(const std::string& directory) {
+
+	int formatCount = 0;
+	if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) {
+		GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+	}
+
+	s_Enabled = formatCount > 0;
+	if (!s_Enabled) {
+		std::cout << "[Shader] Program binaries not supported, shaders are always compiled from source" << std::endl;
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		std::cout << "[Shader] Can't create the program binary cache directory " << directory << ": " << error.message() << std::endl;
+		s_Enabled = false;
+		return;
+	}
+
+	s_Directory = directory;
+	s_ContextID = GetString(GL_VENDOR) + '\n' + GetString(GL_RENDERER) + '\n' + GetString(GL_VERSION);
+}
+
+uint64_t ProgramBinaryCache::MakeKey(const std::string* sources, unsigned int count) {
+
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (unsigned int i = 0; i < count; i++)
+		HashString(hash, sources[i]);
+	HashString(hash, s_ContextID);
+	return hash;
+}
+
+std::string ProgramBinaryCache::GetPath(uint64_t key) {
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return s_Directory + '/' + name;
+}
+
+unsigned int ProgramBinaryCache::Load(uint64_t key) {
+
+	if (!s_Enabled)
+		return 0;
+
+	const std::string path = GetPath(key);
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		s_Misses++;
+		return 0;
+	}
+
+	ProgramBinaryHeader header = {};
+	std::vector<char> binary;
+	if (file.read((char*)&header, sizeof(header)) && header.Magic == s_BinaryMagic && header.Version == s_BinaryVersion && header.Key == key) {
+		binary.resize(header.Length);
+		if (!file.read(binary.data(), header.Length))
+			binary.clear();
+	}
+	file.close();
+
+	unsigned int program = 0;
+	int linked = GL_FALSE;
+	if (!binary.empty()) {
+		program = glCreateProgram();
+		GLCall(glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size()));
+		GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	}
+
+	if (linked == GL_FALSE) {
+		// Truncated, from another build of the cache, or the driver doesn't want it any more: compile from source and store a new one.
+		if (program != 0) {
+			GLCall(glDeleteProgram(program));
+		}
+		std::remove(path.c_str());
+		s_Misses++;
+		return 0;
+	}
+
+	s_Hits++;
+	return program;
+}
+
+void ProgramBinaryCache::Store(uint64_t key, unsigned int program) {
+
+	if (!s_Enabled)
+		return;
+
+	int length = 0;
+	GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	ProgramBinaryHeader header = { s_BinaryMagic, s_BinaryVersion, key, 0, 0 };
+	GLsizei written = 0;
+	GLenum format = 0;
+	GLCall(glGetProgramBinary(program, length, &written, &format, binary.data()));
+	header.Format = format;
+	header.Length = (uint32_t)written;
+
+	// Written under a temporary name first, so a crash halfway through never leaves a truncated blob under the real name.
+	const std::string path = GetPath(key);
+	const std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		file.write((const char*)&header, sizeof(header));
+		file.write(binary.data(), written);
+		if (!file) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+		std::remove(tempPath.c_str());
+}
+
+void ProgramBinaryCache::PrepareProgram(unsigned int program) {
+
+	if (!s_Enabled)
+		return;
+
+	GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+
+// Notes regarding ProgramBinaryCache
+/*
+	Compiling and linking every shader from source on every launch is a big part of the time it takes to get the first frame on screen. GL 4.1
+	(ARB_get_program_binary) can hand out a linked program as an opaque driver-specific blob (glGetProgramBinary()) and load it back later 
+	(glProgramBinary()), which skips the compiler completely.
+
+	Each blob is stored as its own file in the cache directory, named after a hash of the program's source plus the GL_VENDOR, GL_RENDERER and GL_VERSION
+	strings. A driver update or another GPU changes the hash, so old blobs are simply never looked up again. The driver may still reject a blob (it is allowed
+	to for any reason), in which case Load() deletes the file and Shader compiles from source as before, storing a fresh blob.
+
+	Does nothing until Init() is called, or if the context offers no binary formats.
+*/
+class ProgramBinaryCache {
+
+private:
+
+	static bool s_Enabled;
+	static std::string s_Directory;
+	static std::string s_ContextID; // vendor + renderer + version, part of every key
+	static unsigned int s_Hits;
+	static unsigned int s_Misses;
+
+public:
+
+	// Call once after glewInit(). Creates 'directory' if it doesn't exist yet.
+	static void Init(const std::string& directory = "shadercache");
+
+	inline static bool IsEnabled() { return s_Enabled; }
+
+	// The key of a program made of these stage sources on this context. Pass the sources exactly as they are handed to glShaderSource(), one per stage in
+	// a fixed order (empty for a missing stage), so the same text in another stage gives another key.
+	static uint64_t MakeKey(const std::string* sources, unsigned int count);
+
+	// A linked program created from the stored blob, 0 if there is none or the driver rejected it.
+	static unsigned int Load(uint64_t key);
+	// Stores the blob of the linked 'program'. Only works if PrepareProgram() was called before linking it.
+	static void Store(uint64_t key, unsigned int program);
+	// Asks the driver to keep the blob of 'program' around, call before glLinkProgram().
+	static void PrepareProgram(unsigned int program);
+
+	inline static unsigned int GetHitCount() { return s_Hits; }
+	inline static unsigned int GetMissCount() { return s_Misses; }
+
+private:
+
+	static std::string GetPath(uint64_t key);
+};
@@ -1,35 +1,268 @@
 #include "Renderer.h"
 
+#include <cstdint>
 #include <iostream>
+#include <utility>
 
+#include "UniformBuffer.h"
 
-void GLClearError() {
 
-	// Clears all the errors from OpenGL.
-	// glGetError only returns 1 error at once, from a list of errors, thus in order to know what the errors are, you have to loop through, until GL_NO_ERROR is returned. 
-	while (glGetError() != GL_NO_ERROR);
+void Renderer::Clear() const {
+
+	GLCall(glClear(GL_COLOR_BUFFER_BIT));
 }
 
-bool GLLogCall(const char* function, const char* file, int line) {
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) {
+	// Check EP16-EP18 notes, no need to bind VBO, because VBO is remembered by the VAO, as in, the VAO remembers which VBO does its VAAs assosciates to. 
+	// However VAO don't rememvber which IBO its assosciated to. 
+	// The binds go through GLState, so if the same objects are drawn twice in a row the second set of binds never reaches the driver.
+	// The base vertex is 0 unless the VBO is a BufferArena view, the VAO's attributes point at the start of the arena's buffer.
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, (void*)(uintptr_t)ib.GetOffset(), va.GetBaseVertex()));
 
-	while (GLenum error = glGetError()) {
-		// Now prints the flag, and also function and file name, and line.
-		std::cout << "[OpenGL Error] (" << error << "): " << function << " " << file << ": " << line << std::endl;
-		return false;
-	}
-	return true;
+	m_Stats.ShaderBinds++;
+	m_Stats.VertexArrayBinds++;
+	m_Stats.IndexBufferBinds++;
+	m_Stats.DrawCalls++;
 }
 
-void Renderer::Clear() const {
+void Renderer::Draw(VertexFormat format, const VertexBuffer& vb, const IndexBuffer& ib, const Shader& shader) {
 
-	GLCall(glClear(GL_COLOR_BUFFER_BIT));
+	// The buffer offset goes into the vertex buffer binding (or the fallback VAO), so arena views need no base vertex here.
+	shader.Bind();
+	VertexFormatCache::Bind(format, vb);
+	ib.Bind();
+	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, (const void*)(uintptr_t)ib.GetOffset()));
+
+	m_Stats.ShaderBinds++;
+	m_Stats.VertexArrayBinds++;
+	m_Stats.IndexBufferBinds++;
+	m_Stats.DrawCalls++;
 }
 
-void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const {
-	// Check EP16-EP18 notes, no need to bind VBO, because VBO is remembered by the VAO, as in, the VAO remembers which VBO does its VAAs assosciates to. 
-	// However VAO don't rememvber which IBO its assosciated to. 
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) {
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+	GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, (void*)(uintptr_t)ib.GetOffset(), instanceCount, va.GetBaseVertex()));
+
+	m_Stats.ShaderBinds++;
+	m_Stats.VertexArrayBinds++;
+	m_Stats.IndexBufferBinds++;
+	m_Stats.DrawCalls++;
+}
+
+void Renderer::DrawRange(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const MeshRange& mesh) {
+
 	shader.Bind();
 	va.Bind();
 	ib.Bind();
-	GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+	GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, mesh.IndexCount, GL_UNSIGNED_INT, (void*)(uintptr_t)(mesh.FirstIndex * sizeof(unsigned int)), mesh.BaseVertex));
+
+	m_Stats.ShaderBinds++;
+	m_Stats.VertexArrayBinds++;
+	m_Stats.IndexBufferBinds++;
+	m_Stats.DrawCalls++;
+}
+
+MeshRange Renderer::GetMeshRange(const VertexBuffer& vb, unsigned int stride, const IndexBuffer& ib) {
+
+	return { ib.GetCount(), ib.GetFirstIndex(), vb.GetBaseVertex(stride) };
+}
+
+void Renderer::DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, IndirectDrawBuffer& commands) {
+
+	if (commands.GetCommandCount() == 0)
+		return;
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+
+	m_Stats.ShaderBinds++;
+	m_Stats.VertexArrayBinds++;
+	m_Stats.IndexBufferBinds++;
+
+	if (IndirectDrawBuffer::IsSupported()) {
+		commands.Upload();
+		GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, commands.GetCommandCount(), 0));
+		m_Stats.DrawCalls++;
+		return;
+	}
+
+	if (commands.BuildFallbackArrays()) {
+		GLCall(glMultiDrawElementsBaseVertex(GL_TRIANGLES, commands.GetCounts(), GL_UNSIGNED_INT, commands.GetIndexOffsets(), commands.GetCommandCount(), 
+			commands.GetBaseVertices()));
+		m_Stats.DrawCalls++;
+		return;
+	}
+
+	for (unsigned int i = 0; i < commands.GetCommandCount(); i++) {
+		const DrawElementsIndirectCommand& command = commands.GetCommands()[i];
+		GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, GL_UNSIGNED_INT, commands.GetIndexOffsets()[i], command.InstanceCount, command.BaseVertex));
+		m_Stats.DrawCalls++;
+	}
+}
+
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int material, float depth) {
+
+	m_CommandQueue.push_back({ MakeSortKey(shader.GetRendererID(), va.GetRendererID(), material, depth), &va, &ib, &shader, 0, 0 });
+}
+
+void Renderer::SubmitWithUniforms(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const void* uniforms, unsigned int uniformSize, unsigned int material, 
+	float depth) {
+
+	const unsigned int uniformOffset = m_UniformRing.Push(uniforms, uniformSize);
+	m_CommandQueue.push_back({ MakeSortKey(shader.GetRendererID(), va.GetRendererID(), material, depth), &va, &ib, &shader, uniformOffset, uniformSize });
+}
+
+void Renderer::SetDrawUniformBlock(const std::string& blockName) {
+
+	m_DrawBlockBinding = UniformBuffer::GetBindingPoint(blockName);
+	m_DrawBlockSet = true;
+}
+
+void Renderer::Flush() {
+
+	SortCommands();
+
+	// The per-draw uniforms of every queued draw go up in one copy, each draw then only selects its slot with glBindBufferRange().
+	if (!m_UniformRing.IsEmpty()) {
+		if (!m_DrawBlockSet)
+			SetDrawUniformBlock("Draw");
+		m_UniformRing.Upload();
+	}
+
+	// 0 is never a valid name for a program/VAO/buffer we draw with, so it works as "nothing bound yet".
+	unsigned int boundProgram = 0;
+	unsigned int boundVertexArray = 0;
+	unsigned int boundIndexBuffer = 0;
+
+	for (const DrawCommand& command : m_CommandQueue) {
+
+		if (command.Program->GetRendererID() != boundProgram) {
+			command.Program->Bind();
+			boundProgram = command.Program->GetRendererID();
+			m_Stats.ShaderBinds++;
+		}
+
+		if (command.VA->GetRendererID() != boundVertexArray) {
+			command.VA->Bind();
+			boundVertexArray = command.VA->GetRendererID();
+			boundIndexBuffer = 0; // the element array binding is part of the VAO state, so switching VAO also switches the bound IBO
+			m_Stats.VertexArrayBinds++;
+		}
+
+		if (command.IB->GetRendererID() != boundIndexBuffer) {
+			command.IB->Bind();
+			boundIndexBuffer = command.IB->GetRendererID();
+			m_Stats.IndexBufferBinds++;
+		}
+
+		if (command.UniformSize != 0) {
+			m_UniformRing.Bind(m_DrawBlockBinding, command.UniformOffset, command.UniformSize);
+			m_Stats.UniformRangeBinds++;
+		}
+
+		GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, command.IB->GetCount(), GL_UNSIGNED_INT, (void*)(uintptr_t)command.IB->GetOffset(), 
+			command.VA->GetBaseVertex()));
+		m_Stats.DrawCalls++;
+	}
+
+	m_CommandQueue.clear(); // keeps the capacity, so the queue stops allocating once it has grown to the size of a frame
+	m_UniformRing.Clear();
+}
+
+void Renderer::BeginDepthPass() const {
+
+	// Clear() only clears colour, without this the prepass would test against the depth of the previous frame. The depth mask has to be on for the clear.
+	GLCall(glEnable(GL_DEPTH_TEST));
+	GLCall(glDepthFunc(GL_LESS));
+	GLCall(glDepthMask(GL_TRUE));
+	GLCall(glClear(GL_DEPTH_BUFFER_BIT));
+	GLCall(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+}
+
+void Renderer::EndDepthPass() const {
+
+	// The colour pass after a prepass only has to draw what is visible, which is exactly what passes GL_LEQUAL against the prepass depth.
+	GLCall(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+	GLCall(glDepthFunc(GL_LEQUAL));
+}
+
+void Renderer::EndColorPass() const {
+
+	GLCall(glDepthFunc(GL_LESS));
+	GLCall(glDisable(GL_DEPTH_TEST));
+}
+
+void Renderer::ResetStats() {
+
+	m_Stats = RendererStats();
+}
+
+uint64_t Renderer::MakeSortKey(unsigned int program, unsigned int vao, unsigned int material, float depth) {
+
+	// Converting a float outside the integer's range (or NaN) is undefined behaviour, so depth is clamped first. NaN fails every comparison, the '!'
+	// form sends it to 0.
+	if (!(depth >= 0.0f)) depth = 0.0f;
+	if (depth > 1.0f) depth = 1.0f;
+
+	uint64_t key = 0;
+	key |= (uint64_t)(program  & 0xFFF)  << 52;
+	key |= (uint64_t)(vao      & 0xFFF)  << 40;
+	key |= (uint64_t)(material & 0xFFFF) << 24;
+	key |= (uint64_t)(depth * 0xFFFFFF);
+	return key;
+}
+
+// Notes regarding the radix sort used below
+/*
+	An LSD (least significant digit) radix sort looks at the key one byte at a time, starting with the lowest byte. Every pass is a stable counting sort into 256 
+	buckets, so after the 8th pass the commands are ordered by the full 64 bit key. This is O(n) instead of the O(n log n) of std::sort, and it never compares 
+	two commands directly.
+
+	Most frames only use a handful of programs/VAOs, so a lot of the bytes are the same for every command. If every key lands in one bucket, the pass wouldn't 
+	change anything and is skipped.
+*/
+void Renderer::SortCommands() {
+
+	const size_t count = m_CommandQueue.size();
+	if (count < 2)
+		return;
+
+	m_SortScratch.resize(count);
+
+	DrawCommand* src = m_CommandQueue.data();
+	DrawCommand* dst = m_SortScratch.data();
+
+	for (unsigned int shift = 0; shift < 64; shift += 8) {
+
+		size_t histogram[256] = {};
+		for (size_t i = 0; i < count; i++)
+			histogram[(src[i].SortKey >> shift) & 0xFF]++;
+
+		if (histogram[(src[0].SortKey >> shift) & 0xFF] == count)
+			continue;
+
+		// Turns the histogram into the starting index of every bucket (exclusive prefix sum).
+		size_t offset = 0;
+		for (size_t& bucket : histogram) {
+			size_t bucketSize = bucket;
+			bucket = offset;
+			offset += bucketSize;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			dst[histogram[(src[i].SortKey >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	// After an odd number of passes the sorted data lives in the scratch buffer.
+	if (src != m_CommandQueue.data())
+		m_CommandQueue.swap(m_SortScratch);
 }
@@ -2,27 +2,104 @@
 
 #include <GL/glew.h>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GLDebug.h"
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "IndirectDrawBuffer.h"
+#include "UniformRing.h"
+#include "VertexFormatCache.h"
+
 
+// A draw that has been recorded by Renderer::Submit() but not yet executed. The commands are executed by Renderer::Flush() in SortKey order, so that draws 
+// using the same shader program and VAO end up next to each other and the binds between them can be skipped.
+struct DrawCommand {
 
-// MSVC specific function. __ means that its compiler intrinsic. This essentially inserts a breakpoint whenver an error is encountered. 
-#define ASSERT(x) if (!x) __debugbreak(); // Only works in debug mode. 
-#define GLCall(x) GLClearError();\
-				x;\
-				ASSERT(GLLogCall(#x, __FILE__, __LINE__))
-				//'#x' converts x into a string // __FILE__ and __LINE__ is supported by all compilers, unlike __debugbreak(), which is only for MSVCs
+	uint64_t SortKey;
+	const VertexArray* VA;
+	const IndexBuffer* IB;
+	const Shader* Program;
+	unsigned int UniformOffset; // the draw's block in the renderer's UniformRing
+	unsigned int UniformSize;   // 0 if the draw has no per-draw uniforms
+};
 
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+// Counts how many state changes the renderer actually issued, reset with Renderer::ResetStats() (usually once per frame).
+struct RendererStats {
 
+	unsigned int DrawCalls = 0;
+	unsigned int ShaderBinds = 0;
+	unsigned int VertexArrayBinds = 0;
+	unsigned int IndexBufferBinds = 0;
+	unsigned int UniformRangeBinds = 0;
+};
 
 class Renderer {
 
+private:
+
+	std::vector<DrawCommand> m_CommandQueue;
+	std::vector<DrawCommand> m_SortScratch; // ping-pong buffer for the radix sort, kept as a member so that Flush() doesn't allocate every frame
+	RendererStats m_Stats;
+	UniformRing m_UniformRing;
+	unsigned int m_DrawBlockBinding = 0;
+	bool m_DrawBlockSet = false;
+
 public:
 
 	void Clear() const;
-	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader);
+	// Draws 'vb' through the shared VAO of 'format' (see VertexFormatCache), switching meshes of the same layout only rebinds the vertex buffer.
+	void Draw(VertexFormat format, const VertexBuffer& vb, const IndexBuffer& ib, const Shader& shader);
+	// Draws the mesh 'instanceCount' times in one draw call, the per-instance data comes from buffers added with a per-instance layout (see SetInstanceDivisor()).
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount);
+	// Draws one mesh out of buffers shared with other meshes, 'ib' is only bound, the indices come from 'mesh'. See BufferArena.
+	void DrawRange(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const MeshRange& mesh);
+	// Draws every mesh in 'commands' out of the shared va/ib with a single multi draw call (see IndirectDrawBuffer).
+	void DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, IndirectDrawBuffer& commands);
+
+	// Records a draw into the frame queue instead of drawing immediately. 'material' and 'depth' only affect the order the queue is executed in.
+	void Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int material = 0, float depth = 0.0f);
+	// Same, with a block of per-draw uniforms (a std140 struct, see Std140.h) that the shader reads from its per-draw uniform block (see SetDrawUniformBlock()).
+	// A name of its own, an overload would be ambiguous with the one above for calls like Submit(va, ib, shader, 0, 1).
+	void SubmitWithUniforms(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const void* uniforms, unsigned int uniformSize, unsigned int material = 0, 
+		float depth = 0.0f);
+	// Sorts the queued draws and executes them, only rebinding the shader/VAO/IBO when it differs from the previous draw.
+	void Flush();
+
+	// Between these two, draws only write depth (no colour), for depth prepasses and shadow maps. Draw position-only VAOs with a minimal shader here
+	// (see MultiStreamMesh and res/shaders/Depth.shader), so the pass doesn't fetch attributes it never uses. BeginDepthPass() clears the depth buffer.
+	void BeginDepthPass() const;
+	// Starts the colour pass: colour writes back on, depth tested with GL_LEQUAL against the prepass.
+	void EndDepthPass() const;
+	// Ends the colour pass, depth testing goes back to the default (off, GL_LESS) so later 2D draws (e.g. the BatchRenderer) aren't depth tested.
+	void EndColorPass() const;
+
+	// The name of the uniform block that per-draw uniforms are bound to, "Draw" if never set.
+	void SetDrawUniformBlock(const std::string& blockName);
+
+	inline const RendererStats& GetStats() const { return m_Stats; }
+
+	// Where the mesh made of two arena views lives inside the arena's shared buffers, for DrawRange() and IndirectDrawBuffer::Add().
+	static MeshRange GetMeshRange(const VertexBuffer& vb, unsigned int stride, const IndexBuffer& ib);
+	void ResetStats();
+
+	/*
+	Sort key layout (most significant bits are sorted on first):
+
+		| 63 .. 52 | 51 .. 40 | 39 .. 24 | 23 .. 0 |
+		| program  |   VAO    | material |  depth  |
+
+	The GL object names are masked to 12 bits. Two objects that collide after masking only end up interleaved in the queue, the binds themselves are still 
+	decided by comparing the real IDs in Flush(). Depth is expected to be in the [0, 1] range and is sorted front to back, values outside of it are clamped (NaN sorts as 0).
+	*/
+	static uint64_t MakeSortKey(unsigned int program, unsigned int vao, unsigned int material, float depth);
+
+private:
+
+	void SortCommands();
 };
 
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// A 32 bit reference to a resource inside a ResourcePool<T>: the low 20 bits are the slot, the high 12 bits the generation of the slot. The type parameter only
+// stops a handle of one pool from being used with another pool, it isn't stored.
+template<typename T>
+struct ResourceHandle {
+
+	uint32_t Value = 0; // 0 is never handed out (generations start at 1), so a default constructed handle is always invalid
+
+	inline bool operator==(const ResourceHandle& other) const { return Value == other.Value; }
+	inline bool operator!=(const ResourceHandle& other) const { return Value != other.Value; }
+};
+
+// Notes regarding ResourcePool
+/*
+	Owns resources (VertexArray, VertexBuffer, IndexBuffer, Shader...) in one contiguous std::vector, so walking over all of them is a linear walk through memory,
+	and hands out small handles instead of pointers.
+
+	A handle doesn't point at the resource directly, it points at a slot, and the slot knows where in the vector the resource currently is. When a resource is
+	destroyed the last resource is moved into its place (so the vector stays without holes) and only its slot is updated. That's why T has to be movable, and
+	why the GL wrapper classes are move-only: a copy would delete the same GL object twice.
+
+	Every time a slot is reused its generation goes up. A handle to a destroyed resource still has the old generation, so Get() can tell it is stale with one
+	compare instead of handing out a pointer to whatever lives in the slot now.
+
+	Pointers returned by Get() are only valid until the next Create()/Destroy(), keep handles, not pointers.
+*/
+template<typename T>
+class ResourcePool {
+
+private:
+
+	static const uint32_t IndexBits = 20;
+	static const uint32_t IndexMask = (1u << IndexBits) - 1;
+	static const uint32_t GenerationMask = (1u << (32 - IndexBits)) - 1;
+
+	struct Slot {
+
+		uint32_t DenseIndex;
+		uint32_t Generation;
+	};
+
+	std::vector<T> m_Resources;           // dense, no holes
+	std::vector<uint32_t> m_ResourceSlot; // for every resource, the slot pointing at it
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+
+public:
+
+	ResourcePool() = default;
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	// Constructs the resource in place, the arguments are forwarded to T's constructor.
+	template<typename... Args>
+	ResourceHandle<T> Create(Args&&... args) {
+
+		uint32_t slot;
+		if (!m_FreeSlots.empty()) {
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else {
+			slot = (uint32_t)m_Slots.size();
+			m_Slots.push_back({ 0, 1 });
+		}
+
+		m_Slots[slot].DenseIndex = (uint32_t)m_Resources.size();
+		m_Resources.emplace_back(std::forward<Args>(args)...);
+		m_ResourceSlot.push_back(slot);
+
+		return { (m_Slots[slot].Generation << IndexBits) | slot };
+	}
+
+	void Destroy(ResourceHandle<T> handle) {
+
+		if (!IsValid(handle))
+			return;
+
+		const uint32_t slot = handle.Value & IndexMask;
+		const uint32_t index = m_Slots[slot].DenseIndex;
+		const uint32_t last = (uint32_t)m_Resources.size() - 1;
+
+		// Fills the hole with the last resource. The move assignment releases the GL object of the destroyed resource.
+		if (index != last) {
+			m_Resources[index] = std::move(m_Resources[last]);
+			m_ResourceSlot[index] = m_ResourceSlot[last];
+			m_Slots[m_ResourceSlot[index]].DenseIndex = index;
+		}
+		m_Resources.pop_back();
+		m_ResourceSlot.pop_back();
+
+		// Generation 0 is skipped when wrapping around, so a valid handle is never 0.
+		uint32_t& generation = m_Slots[slot].Generation;
+		generation = (generation + 1) & GenerationMask;
+		if (generation == 0)
+			generation = 1;
+
+		m_FreeSlots.push_back(slot);
+	}
+
+	inline bool IsValid(ResourceHandle<T> handle) const {
+
+		const uint32_t slot = handle.Value & IndexMask;
+		return slot < m_Slots.size() && m_Slots[slot].Generation == (handle.Value >> IndexBits);
+	}
+
+	// nullptr if the handle is stale (or was never valid).
+	inline T* Get(ResourceHandle<T> handle) { return IsValid(handle) ? &m_Resources[m_Slots[handle.Value & IndexMask].DenseIndex] : nullptr; }
+	inline const T* Get(ResourceHandle<T> handle) const { return IsValid(handle) ? &m_Resources[m_Slots[handle.Value & IndexMask].DenseIndex] : nullptr; }
+
+	inline unsigned int GetSize() const { return (unsigned int)m_Resources.size(); }
+
+	// Iterates over the resources in memory order (not creation order).
+	inline typename std::vector<T>::iterator begin() { return m_Resources.begin(); }
+	inline typename std::vector<T>::iterator end() { return m_Resources.end(); }
+};
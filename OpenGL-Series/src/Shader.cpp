@@ -1,56 +1,148 @@
 #include "Shader.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <fstream> // file stream
-#include <sstream>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "UniformBuffer.h"
+#include "DirectStateAccess.h"
+#include "ProgramBinaryCache.h"
+#include "FileWatcher.h"
+#include "MappedFile.h"
 
 
-Shader::Shader(const std::string& filepath)
-	: m_Filepath(filepath), m_RendererID(0)
+unsigned int Shader::s_FallbackProgram = 0;
+
+// Every live Shader, so hot reload can find the ones whose file changed. GL thread only, like the Shader objects themselves.
+static std::vector<Shader*> s_Shaders;
+static std::unique_ptr<FileWatcher> s_Watcher;
+
+
+Shader::Shader(const std::string& filepath, ShaderCompileMode mode)
+	: Shader(filepath, {}, mode)
+{}
+
+Shader::Shader(const std::string& filepath, const std::vector<ShaderDefine>& defines, ShaderCompileMode mode)
+	: m_Filepath(filepath), m_Defines(defines), m_RendererID(0), m_State(ProgramState::Compiling)
 {
-	ShaderProgramSource source = ParseShader(m_Filepath);
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	ShaderProgramSource source = LoadSource();
+	m_Build = StartProgram(source);
+	m_RendererID = m_Build.Program;
+
+	if (!m_Build.Pending) {
+		m_State = ProgramState::Ready; // came from the binary cache, already linked
+		OnProgramReady();
+	}
+	else if (mode == ShaderCompileMode::Blocking)
+		FinishInitialBuild(); // checking the results right away waits for the driver, which is exactly what the blocking mode is for
 
+	s_Shaders.push_back(this);
+	if (s_Watcher) {
+		for (const std::string& file : m_Files)
+			s_Watcher->Watch(file);
+	}
+}
+
+Shader::~Shader() { 
+	
+	Release(); 
+	s_Shaders.erase(std::find(s_Shaders.begin(), s_Shaders.end(), this));
 }
 
-Shader::~Shader() {
+Shader::Shader(Shader&& other) noexcept
+	: m_Filepath(std::move(other.m_Filepath)), m_Defines(std::move(other.m_Defines)), m_Files(std::move(other.m_Files)), m_RendererID(other.m_RendererID), 
+	  m_UniformSlots(std::move(other.m_UniformSlots)), m_UniformLocations(std::move(other.m_UniformLocations)), 
+	  m_UniformNames(std::move(other.m_UniformNames)), m_MissingUniforms(std::move(other.m_MissingUniforms)), 
+	  m_PendingUniforms(std::move(other.m_PendingUniforms)), m_Build(other.m_Build), m_State(other.m_State), m_Reload(other.m_Reload), m_ReloadDetectedAt(other.m_ReloadDetectedAt), 
+	  m_ReloadStartedAt(other.m_ReloadStartedAt)
+{
+	other.m_RendererID = 0;
+	other.m_Build = ProgramBuild();
+	other.m_Reload = ProgramBuild();
+	other.m_State = ProgramState::Failed;
 
-	GLCall(glDeleteProgram(m_RendererID));
+	s_Shaders.push_back(this);
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath) {
-	
-	std::ifstream stream(filepath); // ifstream = input file stream
+Shader& Shader::operator=(Shader&& other) noexcept {
+
+	if (this != &other) {
+		Release();
+
+		m_Filepath = std::move(other.m_Filepath);
+		m_Defines = std::move(other.m_Defines);
+		m_Files = std::move(other.m_Files);
+		m_RendererID = other.m_RendererID;
+		m_UniformSlots = std::move(other.m_UniformSlots);
+		m_UniformLocations = std::move(other.m_UniformLocations);
+		m_UniformNames = std::move(other.m_UniformNames);
+		m_MissingUniforms = std::move(other.m_MissingUniforms);
+		m_PendingUniforms = std::move(other.m_PendingUniforms);
+		m_Build = other.m_Build;
+		m_State = other.m_State;
+		m_Reload = other.m_Reload;
+		m_ReloadDetectedAt = other.m_ReloadDetectedAt;
+		m_ReloadStartedAt = other.m_ReloadStartedAt;
+
+		other.m_RendererID = 0;
+		other.m_Build = ProgramBuild();
+		other.m_Reload = ProgramBuild();
+		other.m_State = ProgramState::Failed;
+	}
+	return *this;
+}
 
-	enum class ShaderType {
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
-	};
+void Shader::Release() {
 
-	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
+	ReleaseBuild(m_Reload);
+	ReleaseBuild(m_Build);
+	m_RendererID = 0;
+}
 
-	while (getline(stream, line)) { // getline(), imported from string lib. Returns true, if there are still more lines to read inside the file. 
+ShaderProgramSource Shader::LoadSource() {
 
-		if (line.find("#shader") != std::string::npos) { // npos means hasn't found, or false. Thus, this if condition is, IF the word "shader" is found in the line....
+	ShaderProgramSource source;
+	m_Files = { ShaderPreprocessor::NormalisePath(m_Filepath) };
 
-			// We need to then see which type of shader is it. 
-			if (line.find("vertex") != std::string::npos) {
-				type = ShaderType::VERTEX;
-			}
-			else if (line.find("fragment") != std::string::npos) {
-				type = ShaderType::FRAGMENT;
-			}
-		}
-		else {
-			// pushes line by line, the contents of the shaderfile into the stringstream.
-			ss[(int)type] << line << '\n';
-		}
+	// The stages are views into the mapped file, the only copy made is the preprocessor's output.
+	MappedFile file(m_Filepath);
+	if (!file.IsOpen()) {
+		std::cout << "[Shader] Can't open " << m_Filepath << std::endl;
+		return source;
+	}
+	const ShaderFileSlices slices = ShaderParser::Parse(file.GetView(), m_Filepath);
+
+	// All stages share one file list, so an include used by several has the same source string number in each.
+	for (unsigned int stage = 0; stage < ShaderStageCount; stage++) {
+		if (slices.FirstLine[stage] != 0)
+			source.Sources[stage] = ShaderPreprocessor::Process(slices.Stages[stage], slices.FirstLine[stage], m_Defines, m_Files);
+	}
+	return source;
+}
 
+static const unsigned int s_GLStages[ShaderStageCount] = { 
+	GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER 
+};
+
+// Geometry shaders are core in 3.2, so they always work on the 3.3 contexts this runs on.
+static bool IsStageSupported(ShaderStage stage) {
+
+	switch (stage) {
+		case ShaderStage::TessControl:
+		case ShaderStage::TessEvaluation:
+			return GLEW_VERSION_4_0 || GLEW_ARB_tessellation_shader;
+		case ShaderStage::Compute:
+			return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+		default:
+			return true;
 	}
-	return { ss[0].str(), ss[1].str() };
 }
 
 
@@ -65,6 +157,13 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 	GLCall(glShaderSource(id, 1, &src, nullptr));
 	GLCall(glCompileShader(id)); // Compiles the shader source code associated with the shader object id.
 
+	// The function returns the ID of the shader. This ID is used to reference the shader in other OpenGL functions, like when attaching it to a shader program.
+	// Nothing waits for the compile here, see CheckCompileStatus().
+	return id;
+}
+
+bool Shader::CheckCompileStatus(unsigned int id, const char* stageName) {
+
 	int result;
 	// retrieves the compilation status of the shader object id. The status is stored in result. If result is GL_FALSE, it indicates the shader did not compile successfully.
 	GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
@@ -79,15 +178,11 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 		char* message = (char*)alloca(length * sizeof(char)); // alloca allows you to allocate stuff dynamically. Allocating memory for error log.
 		GLCall(glGetShaderInfoLog(id, length, &length, message));
 
-		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex shader." : "fragment shader.") << std::endl;
+		std::cout << "Failed to compile " << stageName << " shader." << std::endl;
 		std::cout << message << std::endl;
-
-		GLCall(glDeleteShader(id));
-		return 0;
+		return false;
 	}
-
-	// The function returns the ID of the compiled shader. This ID is used to reference the shader in other OpenGL functions, like when attaching it to a shader program.
-	return id;
+	return true;
 }
 
 // returns an int, which should be the ID of the created shader program --- [below is old comments for main file Application.cpp]
@@ -98,73 +193,638 @@ is no functional difference if the static has been removed. It will still work.
 	has its version of doSomething, and they do not interfere with each other. If doSomething is not marked static, however, the linker will see two global-scope functions
 	with the same name, leading to a conflict.
 */
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader) {
+Shader::ProgramBuild Shader::StartProgram(const ShaderProgramSource& source) {
+
+	ProgramBuild build;
+
+	// A program linked from the same sources on the same driver before comes straight from the binary cache, no compiling at all.
+	build.CacheKey = ProgramBinaryCache::MakeKey(source.Sources.data(), ShaderStageCount);
+	if (unsigned int cached = ProgramBinaryCache::Load(build.CacheKey)) {
+		BindUniformBlocks(cached); // block bindings aren't part of the binary, a loaded program starts with the defaults again
+		build.Program = cached;
+		return build;
+	}
 
 	// This line creates a new shader program and returns its ID. A shader program in OpenGL is used to link together and manage multiple shaders 
 	// (like vertex and fragment shaders).
 	unsigned int program = glCreateProgram();
 
 	// IDs of compiled shader object. This id is used to reference this shader in other OpenGL functions. Like when attaching to a shader program.
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+	for (unsigned int stage = 0; stage < ShaderStageCount; stage++) {
+
+		if (source.Sources[stage].empty())
+			continue;
+
+		// Without the GL version the stage needs, glCreateShader() would fail. Leaving it out makes the link fail instead, with the fallback program as usual.
+		if (!IsStageSupported((ShaderStage)stage)) {
+			std::cout << "[Shader] " << ShaderParser::GetStageName((ShaderStage)stage) << " shaders aren't supported by this context" << std::endl;
+			continue;
+		}
 
-	GLCall(glAttachShader(program, vs)); // Attahes compiled vertex and fragment shader, to the shader program. 
-	GLCall(glAttachShader(program, fs));
+		build.StageShaders[stage] = CompileShader(s_GLStages[stage], source.Sources[stage]);
+		GLCall(glAttachShader(program, build.StageShaders[stage])); // Attahes the compiled stages (vertex, fragment...) to the shader program. 
+	}
+	ProgramBinaryCache::PrepareProgram(program);
 	GLCall(glLinkProgram(program));      // This line links all attached shaders together in the shader program.
 
+	// Nothing is queried yet, any query would make this thread wait for the driver. FinishProgram() checks the results once IsBuildDone() says they are there.
+	build.Program = program;
+	build.Pending = true;
+	return build;
+}
+
+bool Shader::IsBuildDone(const ProgramBuild& build) {
+
+	if (!build.Pending || !IsParallelCompileSupported())
+		return true;
+
+	// Asking for the completion status never blocks, anything else would wait for the compiler threads.
+	int done = GL_FALSE;
+	GLCall(glGetProgramiv(build.Program, GL_COMPLETION_STATUS_KHR, &done));
+	return done == GL_TRUE;
+}
+
+bool Shader::FinishProgram(ProgramBuild& build, const std::vector<std::string>& files) {
+
+	if (!build.Pending)
+		return true;
+
+	bool compiled = true;
+	for (unsigned int stage = 0; stage < ShaderStageCount; stage++) {
+		if (build.StageShaders[stage] != 0)
+			compiled &= CheckCompileStatus(build.StageShaders[stage], ShaderParser::GetStageName((ShaderStage)stage));
+	}
+	if (!compiled) {
+		// The logs say "<source string>(<line>)", see the #line notes in ShaderPreprocessor.h.
+		for (unsigned int i = 0; i < files.size(); i++)
+			std::cout << "  source string " << i << " = " << files[i] << std::endl;
+	}
+
+	int linked = GL_FALSE;
+	GLCall(glGetProgramiv(build.Program, GL_LINK_STATUS, &linked));
+	if (compiled && linked == GL_FALSE) {
+		int length = 0;
+		GLCall(glGetProgramiv(build.Program, GL_INFO_LOG_LENGTH, &length));
+		std::string message(length > 0 ? length : 1, '\0');
+		GLCall(glGetProgramInfoLog(build.Program, length, &length, &message[0]));
+		std::cout << "Failed to link " << files[0] << std::endl;
+		std::cout << message.c_str() << std::endl;
+	}
+
+	// After linking, the individual shader objects are no longer needed, so they are deleted to free up resources.
+	for (unsigned int& stageShader : build.StageShaders) {
+		if (stageShader != 0) {
+			GLCall(glDeleteShader(stageShader));
+		}
+		stageShader = 0;
+	}
+	build.Pending = false;
+
+	if (linked == GL_FALSE)
+		return false;
+
+	BindUniformBlocks(build.Program);
+
+#ifndef NDEBUG
 	// This line validates the shader program for the current OpenGL state. It's used to check whether the program can execute given the current state of bound 
-	// vertex and fragment shaders.
-	GLCall(glValidateProgram(program));
+	// vertex and fragment shaders. It waits for the driver and says little the link status didn't, so only debug builds do it.
+	GLCall(glValidateProgram(build.Program));
+#endif
+
+	ProgramBinaryCache::Store(build.CacheKey, build.Program);
+	return true;
+}
+
+void Shader::ReleaseBuild(ProgramBuild& build) {
+
+	// Stage objects are never used by a draw, so they can go right away.
+	for (unsigned int stageShader : build.StageShaders) {
+		if (stageShader != 0) {
+			GLCall(glDeleteShader(stageShader));
+		}
+	}
+	if (build.Program != 0)
+		DeletionQueue::Release(GLObjectType::Program, build.Program); // deleted once the GPU is done with it
+
+	build = ProgramBuild();
+}
+
+void Shader::FinishInitialBuild() const {
+
+	if (FinishProgram(m_Build, m_Files)) {
+		m_State = ProgramState::Ready;
+		OnProgramReady();
+		return;
+	}
+
+	std::cout << "Shader " << m_Filepath << " is drawn with the fallback program" << std::endl;
+	m_PendingUniforms.clear();
+	m_State = ProgramState::Failed;
+}
+
+bool Shader::IsReady() const {
+
+	if (m_State != ProgramState::Compiling)
+		return m_State == ProgramState::Ready;
+
+	if (!IsBuildDone(m_Build))
+		return false;
+
+	FinishInitialBuild();
+	return m_State == ProgramState::Ready;
+}
+
+void Shader::EnableHotReload() {
+
+	if (s_Watcher)
+		return;
+
+	s_Watcher = std::make_unique<FileWatcher>();
+	for (Shader* shader : s_Shaders) {
+		for (const std::string& file : shader->m_Files)
+			s_Watcher->Watch(file);
+	}
+	std::cout << "[Shader] Hot reload enabled (" << (s_Watcher->IsNative() ? "inotify" : "polling") << ")" << std::endl;
+}
+
+void Shader::DisableHotReload() {
+
+	s_Watcher.reset();
+}
+
+void Shader::ProcessHotReload() {
+
+	if (s_Watcher) {
+		for (const FileChange& change : s_Watcher->PollChanges()) {
+			for (Shader* shader : s_Shaders) {
+				// Saving a shared include rebuilds every shader that includes it.
+				if (shader->m_RendererID != 0 && std::find(shader->m_Files.begin(), shader->m_Files.end(), change.Path) != shader->m_Files.end())
+					shader->StartReload(change.DetectedAt);
+			}
+		}
+	}
+
+	for (Shader* shader : s_Shaders) {
+		if (shader->m_Reload.Program != 0 && IsBuildDone(shader->m_Reload))
+			shader->FinishReload();
+	}
+}
+
+void Shader::StartReload(std::chrono::steady_clock::time_point detectedAt) {
+
+	// A newer save replaces a reload that is still compiling, only the latest version of the file matters.
+	ReleaseBuild(m_Reload);
+
+	m_ReloadDetectedAt = detectedAt;
+	m_ReloadStartedAt = std::chrono::steady_clock::now();
+
+	ShaderProgramSource source = LoadSource();
+	m_Reload = StartProgram(source);
+
+	// The edit may have added includes.
+	for (const std::string& file : m_Files)
+		s_Watcher->Watch(file);
+}
+
+void Shader::FinishReload() {
+
+	const bool linked = FinishProgram(m_Reload, m_Files);
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	const double totalMs = std::chrono::duration<double, std::milli>(now - m_ReloadDetectedAt).count();
+	const double compileMs = std::chrono::duration<double, std::milli>(now - m_ReloadStartedAt).count();
+
+	if (!linked) {
+		ReleaseBuild(m_Reload);
+		std::cout << "[Shader] Reloading " << m_Filepath << " failed " << totalMs << " ms after the change was detected, keeping the last good program" << std::endl;
+		return;
+	}
+
+	// The old program may never have linked (or still be compiling), then there is nothing worth copying from it.
+	if (m_State == ProgramState::Ready)
+		CopyUniformValues(m_RendererID, m_Reload.Program);
+
+	// The swap: from here on Bind() and SetUniform*() use the new program, the old one is deleted once the GPU is done with it.
+	ProgramBuild old = m_Build;
+	m_Build = m_Reload;
+	m_Reload = ProgramBuild();
+	m_RendererID = m_Build.Program;
+	m_State = ProgramState::Ready;
+	ReleaseBuild(old);
+
+	// Locations belong to the program, the new one may have put the same uniforms somewhere else (or added/removed some). If the initial build was still
+	// compiling, the uniforms set in the meantime were never applied, FinishInitialBuild() won't run any more, so they go to this program.
+	OnProgramReady();
+
+	std::cout << "[Shader] Reloaded " << m_Filepath << " " << totalMs << " ms after the change was detected (" << compileMs << " ms parsing and compiling)" 
+		<< std::endl;
+}
+
+void Shader::CopyUniformValues(unsigned int from, unsigned int to) {
+
+	int uniformCount = 0;
+	GLCall(glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &uniformCount));
+
+	for (int i = 0; i < uniformCount; i++) {
+
+		char name[256];
+		GLsizei length = 0;
+		GLint arraySize = 0;
+		GLenum type = 0;
+		GLCall(glGetActiveUniform(from, i, sizeof(name), &length, &arraySize, &type, name));
+
+		// Only the types SetUniform*() can set, members of uniform blocks live in buffers and don't need copying.
+		unsigned int components = 0;
+		bool isInt = false;
+		switch (type) {
+			case GL_FLOAT:      components = 1; break;
+			case GL_FLOAT_VEC2: components = 2; break;
+			case GL_FLOAT_VEC3: components = 3; break;
+			case GL_FLOAT_VEC4: components = 4; break;
+			case GL_INT:
+			case GL_SAMPLER_2D: components = 1; isInt = true; break;
+			default: continue;
+		}
+
+		// Arrays are reported as "name[0]", every element has its own location.
+		std::string baseName(name, length);
+		if (arraySize > 1 && baseName.size() > 3 && baseName.compare(baseName.size() - 3, 3, "[0]") == 0)
+			baseName.resize(baseName.size() - 3);
+
+		for (int element = 0; element < arraySize; element++) {
+
+			const std::string elementName = arraySize > 1 ? baseName + '[' + std::to_string(element) + ']' : baseName;
+			GLCall(int fromLocation = glGetUniformLocation(from, elementName.c_str()));
+			GLCall(int toLocation = glGetUniformLocation(to, elementName.c_str()));
+			if (fromLocation == -1 || toLocation == -1)
+				continue;
+
+			float floats[4] = {};
+			int ints[4] = {};
+			if (isInt) {
+				GLCall(glGetUniformiv(from, fromLocation, ints));
+			}
+			else {
+				GLCall(glGetUniformfv(from, fromLocation, floats));
+			}
+
+			if (DirectStateAccess::IsEnabled()) {
+				if (isInt) {
+					GLCall(glProgramUniform1iv(to, toLocation, 1, ints));
+				}
+				else {
+					switch (components) {
+						case 1: GLCall(glProgramUniform1fv(to, toLocation, 1, floats)); break;
+						case 2: GLCall(glProgramUniform2fv(to, toLocation, 1, floats)); break;
+						case 3: GLCall(glProgramUniform3fv(to, toLocation, 1, floats)); break;
+						case 4: GLCall(glProgramUniform4fv(to, toLocation, 1, floats)); break;
+					}
+				}
+				continue;
+			}
 
-	GLCall(glDeleteShader(vs)); // After linking, the individual shader objects are no longer needed, so these lines delete them to free up resources.
+			GLState::UseProgram(to);
+			if (isInt) {
+				GLCall(glUniform1iv(toLocation, 1, ints));
+			}
+			else {
+				switch (components) {
+					case 1: GLCall(glUniform1fv(toLocation, 1, floats)); break;
+					case 2: GLCall(glUniform2fv(toLocation, 1, floats)); break;
+					case 3: GLCall(glUniform3fv(toLocation, 1, floats)); break;
+					case 4: GLCall(glUniform4fv(toLocation, 1, floats)); break;
+				}
+			}
+		}
+	}
+}
+
+bool Shader::IsParallelCompileSupported() {
+
+	return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+void Shader::InitParallelCompile() {
+
+	// 0xFFFFFFFF = as many threads as the implementation wants to use.
+	if (GLEW_KHR_parallel_shader_compile) {
+		GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+	}
+	else if (GLEW_ARB_parallel_shader_compile) {
+		GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+	}
+	std::cout << "[Shader] Parallel shader compile " << (IsParallelCompileSupported() ? "supported" : "not supported") << std::endl;
+}
+
+// Position only, so it works with any VAO that has a position at location 0 (which every VAO here has).
+static const char* s_FallbackVertexSource = 
+	"#version 330 core\n"
+	"layout(location = 0) in vec4 position;\n"
+	"void main() { gl_Position = position; }\n";
+
+static const char* s_FallbackFragmentSource = 
+	"#version 330 core\n"
+	"layout(location = 0) out vec4 color;\n"
+	"void main() { color = vec4(0.5, 0.5, 0.5, 1.0); }\n";
+
+unsigned int Shader::GetFallbackProgram() {
+
+	if (s_FallbackProgram != 0)
+		return s_FallbackProgram;
+
+	// Small enough that compiling it in place costs next to nothing, and it's only ever done once.
+	unsigned int vs = CompileShader(GL_VERTEX_SHADER, s_FallbackVertexSource);
+	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, s_FallbackFragmentSource);
+	CheckCompileStatus(vs, "vertex");
+	CheckCompileStatus(fs, "fragment");
+
+	s_FallbackProgram = glCreateProgram();
+	GLCall(glAttachShader(s_FallbackProgram, vs));
+	GLCall(glAttachShader(s_FallbackProgram, fs));
+	GLCall(glLinkProgram(s_FallbackProgram));
+	GLCall(glDeleteShader(vs));
 	GLCall(glDeleteShader(fs));
 
-	return program;
+	return s_FallbackProgram;
+}
+
+void Shader::ReleaseFallbackProgram() {
+
+	if (s_FallbackProgram == 0)
+		return;
+
+	DeletionQueue::Release(GLObjectType::Program, s_FallbackProgram);
+	s_FallbackProgram = 0;
+}
+
+void Shader::BindUniformBlocks(unsigned int program) {
+
+	int blockCount = 0;
+	GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+
+	for (int i = 0; i < blockCount; i++) {
+		char name[256];
+		GLsizei length = 0;
+		GLCall(glGetActiveUniformBlockName(program, i, sizeof(name), &length, name));
+		GLCall(glUniformBlockBinding(program, i, UniformBuffer::GetBindingPoint(std::string(name, length))));
+	}
 }
 
 void Shader::Bind() const {
 
-	GLCall(glUseProgram(m_RendererID));
+	GLState::UseProgram(IsReady() ? m_RendererID : GetFallbackProgram());
 }
 
+#ifndef NDEBUG
 void Shader::Unbind() const {
 
-	GLCall(glUseProgram(0));
+	GLState::UseProgram(0);
+}
+#endif
+
+// With direct state access the uniform is written into the program by name (glProgramUniform*), so the shader doesn't have to be bound first. The
+// glUniform* fallback writes into whichever program is in use, so it makes m_RendererID current first: the shader may have been bound while it was still
+// compiling, which bound the fallback program instead. Through GLState, so this costs nothing when it already is.
+void Shader::SetUniform1i(UniformName name, int value) {
+
+	if (!IsReady()) {
+		DeferUniform(name, PendingUniform::ValueType::Int, &value, nullptr, 1);
+		return;
+	}
+	if (DirectStateAccess::IsEnabled()) {
+		GLCall(glProgramUniform1i(m_RendererID, GetUniformLocation(name), value));
+		return;
+	}
+	GLState::UseProgram(m_RendererID);
+	GLCall(glUniform1i(GetUniformLocation(name), value));
+}
+
+void Shader::SetUniform1iv(UniformName name, int count, const int* values) {
+	// Sets 'count' elements of an int array (e.g. an array of sampler2D), starting at element 0.
+	if (!IsReady()) {
+		DeferUniform(name, PendingUniform::ValueType::IntArray, values, nullptr, count);
+		return;
+	}
+	if (DirectStateAccess::IsEnabled()) {
+		GLCall(glProgramUniform1iv(m_RendererID, GetUniformLocation(name), count, values));
+		return;
+	}
+	GLState::UseProgram(m_RendererID);
+	GLCall(glUniform1iv(GetUniformLocation(name), count, values));
 }
 
-void Shader::SetUniform1f(const std::string& name, float value) {
+void Shader::SetUniform1f(UniformName name, float value) {
 	// v1 in parameter means value_1
+	if (!IsReady()) {
+		DeferUniform(name, PendingUniform::ValueType::Float, nullptr, &value, 1);
+		return;
+	}
+	if (DirectStateAccess::IsEnabled()) {
+		GLCall(glProgramUniform1f(m_RendererID, GetUniformLocation(name), value));
+		return;
+	}
+	GLState::UseProgram(m_RendererID);
 	GLCall(glUniform1f(GetUniformLocation(name), value));
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3) {
+void Shader::SetUniform2f(UniformName name, float v0, float v1) {
+
+	if (!IsReady()) {
+		const float values[] = { v0, v1 };
+		DeferUniform(name, PendingUniform::ValueType::Float2, nullptr, values, 2);
+		return;
+	}
+	if (DirectStateAccess::IsEnabled()) {
+		GLCall(glProgramUniform2f(m_RendererID, GetUniformLocation(name), v0, v1));
+		return;
+	}
+	GLState::UseProgram(m_RendererID);
+	GLCall(glUniform2f(GetUniformLocation(name), v0, v1));
+}
+
+void Shader::SetUniform4f(UniformName name, float v0, float v1, float v2, float v3) {
 	// v1 in parameter means value_1
+	if (!IsReady()) {
+		const float values[] = { v0, v1, v2, v3 };
+		DeferUniform(name, PendingUniform::ValueType::Float4, nullptr, values, 4);
+		return;
+	}
+	if (DirectStateAccess::IsEnabled()) {
+		GLCall(glProgramUniform4f(m_RendererID, GetUniformLocation(name), v0, v1, v2, v3));
+		return;
+	}
+	GLState::UseProgram(m_RendererID);
 	GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
 }
 
-// Notes regarding std::unordered_map's usage here
-/*   
-	By using an unordered_map, the function avoids repeatedly calling glGetUniformLocation, which is a relatively slow operation, for uniforms that have already 
-	been queried. The map serves as a cache, storing the locations of uniform variables so that subsequent queries can return the location immediately if it's
-	already known. This can significantly improve performance, especially if GetUniformLocation is called frequently during rendering.
+void Shader::DeferUniform(UniformName name, PendingUniform::ValueType type, const int* ints, const float* floats, int count) {
+
+	// Failed for good, the fallback program has no uniforms of this shader.
+	if (m_State == ProgramState::Failed)
+		return;
+
+	PendingUniform pending = { name.Name, type, {}, {} };
+	if (ints)
+		pending.Ints.assign(ints, ints + count);
+	for (int i = 0; floats && i < count; i++)
+		pending.Floats[i] = floats[i];
+	m_PendingUniforms.push_back(std::move(pending));
+}
+
+void Shader::OnProgramReady() const {
+
+	m_MissingUniforms.clear(); // a name missing from a previous program may exist in this one
+	BuildUniformTable();
+	ApplyPendingUniforms();
+}
+
+void Shader::ApplyPendingUniforms() const {
+
+	if (m_PendingUniforms.empty())
+		return;
+
+	// Without DSA glUniform*() writes to the bound program. Binding it here is harmless, every draw binds its own program through GLState anyway.
+	const bool direct = DirectStateAccess::IsEnabled();
+	if (!direct)
+		GLState::UseProgram(m_RendererID);
+
+	for (const PendingUniform& pending : m_PendingUniforms) {
+
+		const int location = GetUniformLocation(UniformName(pending.Name));
+		const float* v = pending.Floats;
+
+		switch (pending.Type) {
+			case PendingUniform::ValueType::Int:
+				if (direct) {
+					GLCall(glProgramUniform1i(m_RendererID, location, pending.Ints[0]));
+				}
+				else {
+					GLCall(glUniform1i(location, pending.Ints[0]));
+				}
+				break;
+			case PendingUniform::ValueType::IntArray:
+				if (direct) {
+					GLCall(glProgramUniform1iv(m_RendererID, location, (int)pending.Ints.size(), pending.Ints.data()));
+				}
+				else {
+					GLCall(glUniform1iv(location, (int)pending.Ints.size(), pending.Ints.data()));
+				}
+				break;
+			case PendingUniform::ValueType::Float:
+				if (direct) {
+					GLCall(glProgramUniform1f(m_RendererID, location, v[0]));
+				}
+				else {
+					GLCall(glUniform1f(location, v[0]));
+				}
+				break;
+			case PendingUniform::ValueType::Float2:
+				if (direct) {
+					GLCall(glProgramUniform2f(m_RendererID, location, v[0], v[1]));
+				}
+				else {
+					GLCall(glUniform2f(location, v[0], v[1]));
+				}
+				break;
+			case PendingUniform::ValueType::Float4:
+				if (direct) {
+					GLCall(glProgramUniform4f(m_RendererID, location, v[0], v[1], v[2], v[3]));
+				}
+				else {
+					GLCall(glUniform4f(location, v[0], v[1], v[2], v[3]));
+				}
+				break;
+		}
+	}
+
+	m_PendingUniforms.clear();
+	m_PendingUniforms.shrink_to_fit();
+}
+
+// Notes regarding the uniform table
+/*
+	This used to be an std::unordered_map<std::string, int> filled on demand: every SetUniform*() built a std::string from the literal, hashed it (twice, 
+	find() and then operator[]) and called glGetUniformLocation() the first time a name came up.
+
+	Now the names are known up front. When the program links, BuildUniformTable() asks GL for every active uniform (glGetActiveUniform()), gives each one a 
+	dense index and stores its location there. The lookup table maps the FNV hash of the name to that index. UniformName already carries the hash (worked 
+	out at compile time for literals), so GetUniformLocation() is a masked index and a compare or two: no std::string, no hashing, no allocation.
+
+	A matching hash is confirmed with a strcmp() against the stored name, so a misspelled name that happens to share the hash of an active uniform is still
+	reported as missing instead of silently setting the other uniform. Two active uniforms with the same hash both stay reachable, the probe just goes on.
 */
-int Shader::GetUniformLocation(const std::string& name) {
-	
-	// m_UniformLocationCache.end() returns an iterator to the end of the map, which is not the same as the last element but a position following the last element. This is 
-	// used to check if the find operation was successful.
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end()) {
-		// The condition above checks if the uniform name is already in the map. If the find method returns an iterator that is not equal to end(), it means the element was found.
+int Shader::GetUniformLocation(UniformName name) const {
+
+	if (!m_UniformSlots.empty()) {
+		const size_t mask = m_UniformSlots.size() - 1;
+		for (size_t i = name.Hash & mask; m_UniformSlots[i].Index != -1; i = (i + 1) & mask) {
+			const UniformSlot& slot = m_UniformSlots[i];
+			if (slot.Hash == name.Hash && std::strcmp(m_UniformNames[slot.Index].c_str(), name.Name) == 0)
+				return m_UniformLocations[slot.Index];
+		}
+	}
 
-		// Returns the value associated with the key name.In this context, this value is the location of the uniform variable in the shader program, which is an integer.
-		return m_UniformLocationCache[name]; 
+	// Not in the program (misspelled, or optimised out by the compiler because it's unused). GL ignores location -1, so it's only worth a warning, once.
+	if (std::find(m_MissingUniforms.begin(), m_MissingUniforms.end(), name.Hash) == m_MissingUniforms.end()) {
+		m_MissingUniforms.push_back(name.Hash);
+		std::cout << "Warning: uniform '" << name.Name << "' doesn't exist!" << std::endl;
 	}
+	return -1;
+}
+
+void Shader::BuildUniformTable() const {
+
+	m_UniformLocations.clear();
+	m_UniformNames.clear();
+	std::vector<uint32_t> hashes; // of every entry in m_UniformNames
 
-	// The OpenGL function below retreives the location of a uniform variable from the shader program. m_RendererID is presumably the identifier of the shader program, 
-	// and name.c_str() converts the std::string to a C-style string, which is required by OpenGL.
-	GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	if (location == -1) { std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl; }
+	int uniformCount = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &uniformCount));
 
-	m_UniformLocationCache[name] = location; // Adds the key-value pair to the map, with name as the key and location as the value.
-	return location;
+	for (int i = 0; i < uniformCount; i++) {
 
+		char name[256];
+		GLsizei length = 0;
+		GLint arraySize = 0;
+		GLenum type = 0;
+		GLCall(glGetActiveUniform(m_RendererID, i, sizeof(name), &length, &arraySize, &type, name));
+
+		GLCall(int location = glGetUniformLocation(m_RendererID, name));
+		if (location == -1)
+			continue; // a member of a uniform block, set through a UniformBuffer instead
+
+		// Arrays are reported as "name[0]". They can be set as a whole by their plain name, or one element at a time as "name[N]".
+		std::string baseName(name, length);
+		const bool isArray = baseName.size() > 3 && baseName.compare(baseName.size() - 3, 3, "[0]") == 0;
+		if (isArray)
+			baseName.resize(baseName.size() - 3);
+
+		hashes.push_back(HashUniformName(baseName.data(), baseName.size()));
+		m_UniformNames.push_back(baseName);
+		m_UniformLocations.push_back(location);
+
+		for (int element = 0; isArray && element < arraySize; element++) {
+			const std::string elementName = baseName + '[' + std::to_string(element) + ']';
+			GLCall(int elementLocation = glGetUniformLocation(m_RendererID, elementName.c_str()));
+			hashes.push_back(HashUniformName(elementName.data(), elementName.size()));
+			m_UniformNames.push_back(elementName);
+			m_UniformLocations.push_back(elementLocation);
+		}
+	}
+
+	// At most half full, so a probe rarely looks at more than one or two slots.
+	size_t slotCount = 8;
+	while (slotCount < hashes.size() * 2)
+		slotCount *= 2;
+	m_UniformSlots.assign(slotCount, { 0, -1 });
+
+	const size_t mask = slotCount - 1;
+	for (unsigned int index = 0; index < hashes.size(); index++) {
+
+		size_t slot = hashes[index] & mask;
+		while (m_UniformSlots[slot].Index != -1)
+			slot = (slot + 1) & mask;
+
+		m_UniformSlots[slot] = { hashes[index], (int)index };
+	}
 }
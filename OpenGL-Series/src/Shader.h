@@ -1,40 +1,189 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <string>
-#include <unordered_map> // hash map
+#include <vector>
 
+#include "ShaderParser.h"
+#include "ShaderPreprocessor.h"
+#include "UniformName.h"
 
+
+// The final source of every stage, indexed by ShaderStage. Empty for stages the file doesn't have.
 struct ShaderProgramSource {
 
-	std::string VertexSource;
-	std::string FragmentSource;
+	std::array<std::string, ShaderStageCount> Sources;
+};
+
+// How the constructor builds the program. Blocking compiles and links before returning, Async only submits the work to the driver (see Shader::IsReady()).
+enum class ShaderCompileMode {
+	Blocking, Async
 };
 
+// Notes regarding asynchronous shader compilation
+/*
+	Querying GL_COMPLETION_STATUS, GL_LINK_STATUS or validating a program makes the calling thread wait for the driver to finish compiling it. Doing that
+	right after submitting each shader serialises everything: the driver never gets to work on more than one program at a time.
+
+	A Shader created with ShaderCompileMode::Async only submits the compile and link and returns. Creating many of them in a row hands all the work to the 
+	driver up front, and with KHR_parallel_shader_compile (or the ARB version) it compiles them on its own threads. IsReady() asks the driver with 
+	GL_COMPLETION_STATUS_KHR, which never blocks, and only checks the results once everything is done. Without the extension the first IsReady() waits 
+	instead, still after every shader has been submitted.
+
+	Until then Bind() binds a cheap built-in program (position only, flat grey), so the renderer keeps drawing while shaders load. A program that failed to 
+	compile or link keeps using it too. SetUniform*() calls made before the program is ready are recorded and applied in the same order once it is, so 
+	one-off uniforms (e.g. sampler units) can be set right after construction. A program that failed keeps drawing with the fallback, its uniforms are dropped.
+*/
+
+// Notes regarding hot reload
+/*
+	With EnableHotReload() a FileWatcher thread watches the file of every Shader. When one is saved, ProcessHotReload() (once per frame, GL thread) reparses 
+	it and submits the new program the same way an async Shader does, while the old program keeps drawing. Once the driver is done:
+
+	- It linked: the new program takes over in one step (the next Bind() uses it), the uniforms of the old program are copied over, the uniform table 
+	  is rebuilt for the new program and the old program goes to the DeletionQueue.
+	- It didn't: the log is printed and the old program simply stays, so a typo never takes the scene down.
+
+	Each reload prints the time from the FileWatcher detecting the change to the new program being in use, and how much of that was spent compiling. 
+	Detection follows the write immediately with inotify, but may lag it by up to 100 ms on the polling fallback, which the figure doesn't include.
+*/
 class Shader {
 
 private:
 
-	std::string m_Filepath; // m_Filepath is used here only for debugging purposes
+	enum class ProgramState {
+		Compiling, Ready, Failed
+	};
+
+	// A program the driver may still be working on, see StartProgram().
+	struct ProgramBuild {
+
+		unsigned int Program = 0;
+		std::array<unsigned int, ShaderStageCount> StageShaders = {}; // the stage objects until FinishProgram() has checked them
+		bool Pending = false;  // false once FinishProgram() is done, or right away for a program loaded from the ProgramBinaryCache
+		uint64_t CacheKey = 0; // the binary is only stored once the link is known to have succeeded
+	};
+
+	std::string m_Filepath; // the file is read again on hot reload
+	std::vector<ShaderDefine> m_Defines;
+	std::vector<std::string> m_Files; // m_Filepath and everything it #includes, in the order of the #line source string numbers
 	unsigned int m_RendererID; // refer to notes on EP13-15 regarding why is it called m_RendererID // in this case m_RendererID is the ID of the shader programs. 
-	std::unordered_map<std::string, int> m_UniformLocationCache; // caching for uniforms
+
+	// The uniform table, rebuilt from glGetActiveUniform() whenever m_RendererID changes (see BuildUniformTable()). Every active name gets a dense index into
+	// m_UniformLocations, m_UniformSlots maps the name's hash to that index (open addressing, linear probing, the size is a power of two).
+	struct UniformSlot {
+
+		uint32_t Hash;
+		int Index; // -1 = empty slot
+	};
+	mutable std::vector<UniformSlot> m_UniformSlots;
+	mutable std::vector<int> m_UniformLocations;
+	mutable std::vector<std::string> m_UniformNames; // same indices as m_UniformLocations, a hash match is confirmed against the name
+	mutable std::vector<uint32_t> m_MissingUniforms; // names that were asked for but aren't in the program, so the warning is only printed once
+
+	// A SetUniform*() call made while the program was still compiling.
+	struct PendingUniform {
+
+		enum class ValueType {
+			Int, IntArray, Float, Float2, Float4
+		};
+
+		std::string Name; // a copy, the UniformName may point at a string that is gone by the time the program is ready
+		ValueType Type;
+		std::vector<int> Ints;
+		float Floats[4];
+	};
+	mutable std::vector<PendingUniform> m_PendingUniforms; // applied by FinishInitialBuild()
+
+	mutable ProgramBuild m_Build; // the program m_RendererID refers to
+	mutable ProgramState m_State;
+
+	ProgramBuild m_Reload; // hot reload: the replacement being compiled while m_RendererID keeps drawing
+	std::chrono::steady_clock::time_point m_ReloadDetectedAt;
+	std::chrono::steady_clock::time_point m_ReloadStartedAt;
+
+	static unsigned int s_FallbackProgram;
 
 public:
 
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, ShaderCompileMode mode = ShaderCompileMode::Blocking);
+	// Builds the variant of the file with 'defines' injected after #version (see ShaderPreprocessor). ShaderPermutationCache shares variants between users.
+	Shader(const std::string& filepath, const std::vector<ShaderDefine>& defines, ShaderCompileMode mode = ShaderCompileMode::Blocking);
 	~Shader();
 
+	// Move-only, see VertexBuffer.
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
+	// Binds the program, or the fallback program while it isn't ready.
 	void Bind() const;
+	// True once the program has compiled and linked. Never blocks with KHR_parallel_shader_compile, see the notes above.
+	bool IsReady() const;
+
+	// Debug builds only, same as VertexBuffer::Unbind().
+#ifdef NDEBUG
+	inline void Unbind() const {}
+#else
 	void Unbind() const;
+#endif
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	// Setting uniforms. Pass the name as a literal, it's hashed at compile time and looked up without building a std::string (see UniformName.h).
+	void SetUniform1i(UniformName name, int value);
+	void SetUniform1iv(UniformName name, int count, const int* values);
+	void SetUniform1f(UniformName name, float value);
+	void SetUniform2f(UniformName name, float v0, float v1);
+	void SetUniform4f(UniformName name, float v0, float v1, float v2, float v3);
 
-	// Setting uniforms
-	void SetUniform1f(const std::string& name, float value);
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+	// Lets the driver use as many compiler threads as it likes. Call once after glewInit(), does nothing without the extension.
+	static void InitParallelCompile();
+	static bool IsParallelCompileSupported();
+	// Deletes the fallback program, call before destroying the context.
+	static void ReleaseFallbackProgram();
+
+	// Starts/stops watching the files of all shaders (including ones created later). See the notes above.
+	static void EnableHotReload();
+	static void DisableHotReload();
+	// GL thread, once per frame: starts rebuilding the shaders whose file changed and swaps in the ones the driver has finished.
+	static void ProcessHotReload();
 
 private:
 
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	int GetUniformLocation(const std::string& name);
+	// Maps the file, slices it into stages (see ShaderParser) and runs every stage through the ShaderPreprocessor, refreshing m_Files.
+	ShaderProgramSource LoadSource();
+	// Only submits the compile, CheckCompileStatus() waits for it and prints the log if it failed.
+	static unsigned int CompileShader(unsigned int type, const std::string& source);
+	static bool CheckCompileStatus(unsigned int id, const char* stageName);
+	// Submits the compile and link (or loads the program from the ProgramBinaryCache) without waiting for the driver.
+	static ProgramBuild StartProgram(const ShaderProgramSource& source);
+	// Never blocks with KHR_parallel_shader_compile. Without it this is always true and FinishProgram() does the waiting.
+	static bool IsBuildDone(const ProgramBuild& build);
+	// Checks the compile/link results, prints the logs and finishes setting up the program. False if it failed to build.
+	static bool FinishProgram(ProgramBuild& build, const std::vector<std::string>& files);
+	static void ReleaseBuild(ProgramBuild& build);
+	void FinishInitialBuild() const;
+	static unsigned int GetFallbackProgram();
+
+	void StartReload(std::chrono::steady_clock::time_point detectedAt);
+	void FinishReload();
+	// Copies the values of the plain (non-block) uniforms 'from' and 'to' share, so a reloaded program starts where the old one left off.
+	static void CopyUniformValues(unsigned int from, unsigned int to);
+
+	int GetUniformLocation(UniformName name) const;
+	// Records a SetUniform*() call made before the program is ready, see the notes on asynchronous compilation.
+	void DeferUniform(UniformName name, PendingUniform::ValueType type, const int* ints, const float* floats, int count);
+	void ApplyPendingUniforms() const;
+	// m_RendererID has just become usable (first link or hot reload swap): builds the uniform table and applies the pending uniforms.
+	void OnProgramReady() const;
+	// Fills the uniform table from the active uniforms of m_RendererID, call whenever it has just linked.
+	void BuildUniformTable() const;
+	// Points every uniform block of 'program' at the binding point UniformBuffer uses for a block of that name.
+	static void BindUniformBlocks(unsigned int program);
+	void Release();
 };
 
@@ -0,0 +1,87 @@
+#include "ShaderParser.h"
+
+#include <cstring>
+#include <iostream>
+
+
+static constexpr const char* s_StageNames[ShaderStageCount] = { "vertex", "tess_control", "tess_evaluation", "geometry", "fragment", "compute" };
+
+const char* ShaderParser::GetStageName(ShaderStage stage) {
+
+	return s_StageNames[(unsigned int)stage];
+}
+
+static inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// The word at the start of 'text' after skipping blanks, e.g. "vertex" in "  vertex  // comment".
+static std::string_view FirstWord(std::string_view text) {
+
+	size_t begin = 0;
+	while (begin < text.size() && IsBlank(text[begin]))
+		begin++;
+
+	size_t end = begin;
+	while (end < text.size() && !IsBlank(text[end]) && text[end] != '/')
+		end++;
+
+	return text.substr(begin, end - begin);
+}
+
+ShaderFileSlices ShaderParser::Parse(std::string_view text, std::string_view name) {
+
+	static constexpr std::string_view tag = "#shader";
+
+	ShaderFileSlices slices;
+	int stage = -1; // the stage the current lines belong to, -1 = none (before the first tag, or after an unknown one)
+	size_t stageBegin = 0;
+	unsigned int lineNumber = 1;
+
+	const char* data = text.data();
+	const size_t size = text.size();
+	size_t lineBegin = 0;
+
+	while (lineBegin < size) {
+
+		const char* newline = (const char*)std::memchr(data + lineBegin, '\n', size - lineBegin);
+		const size_t lineEnd = newline ? (size_t)(newline - data) : size;
+		const size_t next = newline ? lineEnd + 1 : size;
+
+		// Only a line whose first non-blank characters are "#shader" is a tag, so the word in a comment or string is left alone.
+		size_t first = lineBegin;
+		while (first < lineEnd && IsBlank(data[first]))
+			first++;
+
+		if (lineEnd - first >= tag.size() && std::memcmp(data + first, tag.data(), tag.size()) == 0) {
+
+			if (stage != -1)
+				slices.Stages[stage] = text.substr(stageBegin, lineBegin - stageBegin);
+
+			const std::string_view stageName = FirstWord(text.substr(first + tag.size(), lineEnd - first - tag.size()));
+			stage = -1;
+			for (unsigned int i = 0; i < ShaderStageCount; i++) {
+				if (stageName == s_StageNames[i])
+					stage = (int)i;
+			}
+
+			if (stage == -1) {
+				std::cout << "[Shader] " << name << ":" << lineNumber << ": unknown stage '" << stageName << "', its source is skipped" << std::endl;
+			}
+			else if (slices.FirstLine[stage] != 0) {
+				std::cout << "[Shader] " << name << ":" << lineNumber << ": second " << s_StageNames[stage] << " stage, the first one is ignored" << std::endl;
+			}
+
+			if (stage != -1) {
+				stageBegin = next;
+				slices.FirstLine[stage] = lineNumber + 1;
+			}
+		}
+
+		lineBegin = next;
+		lineNumber++;
+	}
+
+	if (stage != -1)
+		slices.Stages[stage] = text.substr(stageBegin, size - stageBegin);
+
+	return slices;
+}
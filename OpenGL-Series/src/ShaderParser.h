@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+
+enum class ShaderStage {
+	Vertex, TessControl, TessEvaluation, Geometry, Fragment, Compute, Count
+};
+
+constexpr unsigned int ShaderStageCount = (unsigned int)ShaderStage::Count;
+
+// The stages of one .shader file, as views into the file's text. A stage that isn't in the file has an empty view.
+struct ShaderFileSlices {
+
+	std::array<std::string_view, ShaderStageCount> Stages = {};
+	std::array<unsigned int, ShaderStageCount> FirstLine = {}; // the line of the file each stage's source starts at, for the #line directives
+};
+
+// Notes regarding ShaderParser
+/*
+	A .shader file holds several stages, each one starting with a tag line:
+
+		#shader vertex | tess_control | tess_evaluation | geometry | fragment | compute
+
+	Parse() makes a single pass over the text and only records where each stage starts and ends, the stage sources are slices of the input, so nothing is 
+	copied or allocated. Together with MappedFile the file's text is never copied at all until the ShaderPreprocessor builds the final source.
+
+	Text before the first tag, and after a tag Parse() doesn't know, belongs to no stage and is skipped (with a warning for unknown tags). A stage that is 
+	tagged twice keeps the last one, with a warning, since two separate slices can't be one view.
+*/
+class ShaderParser {
+
+public:
+
+	// 'name' is only used in warnings.
+	static ShaderFileSlices Parse(std::string_view text, std::string_view name);
+
+	static const char* GetStageName(ShaderStage stage);
+};
@@ -0,0 +1,48 @@
+#include "ShaderPermutationCache.h"
+
+#include <algorithm>
+
+
+std::unordered_map<uint64_t, std::vector<ShaderPermutationCache::Permutation>> ShaderPermutationCache::s_Permutations;
+unsigned int ShaderPermutationCache::s_Count = 0;
+
+
+static std::string MakeDefineKey(const std::vector<ShaderDefine>& defines) {
+
+	std::vector<ShaderDefine> sorted = defines;
+	std::sort(sorted.begin(), sorted.end(), [](const ShaderDefine& a, const ShaderDefine& b) { return a.Name < b.Name; });
+
+	std::string key;
+	for (const ShaderDefine& define : sorted)
+		key += define.Name + '=' + define.Value + '\n';
+	return key;
+}
+
+Shader& ShaderPermutationCache::Get(const std::string& filepath, const std::vector<ShaderDefine>& defines, ShaderCompileMode mode) {
+
+	const std::string file = ShaderPreprocessor::NormalisePath(filepath);
+
+	// FNV-1a of the path, mixed with the define set hash.
+	uint64_t hash = ShaderPreprocessor::HashDefines(defines);
+	for (char c : file) {
+		hash ^= (unsigned char)c;
+		hash *= 0x100000001B3ull;
+	}
+
+	std::vector<Permutation>& bucket = s_Permutations[hash];
+	const std::string defineKey = MakeDefineKey(defines);
+	for (Permutation& permutation : bucket) {
+		if (permutation.File == file && permutation.DefineKey == defineKey)
+			return *permutation.Program;
+	}
+
+	bucket.push_back({ file, defineKey, std::make_unique<Shader>(filepath, defines, mode) });
+	s_Count++;
+	return *bucket.back().Program;
+}
+
+void ShaderPermutationCache::Clear() {
+
+	s_Permutations.clear(); // each Shader hands its program to the DeletionQueue
+	s_Count = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+
+// Notes regarding ShaderPermutationCache
+/*
+	A feature variant of a shader is the same file with a different set of defines, e.g. Basic.shader with { "USE_TEXTURE", "1" }. Creating a Shader per 
+	user would compile the same variant once per user. Get() looks the variant up by (file, hash of the define set) instead, builds it the first time it is 
+	asked for and hands every later caller the same Shader.
+
+	The defines are compared by value after the hash matches, so two sets that happen to hash the same still get their own variant. The order the defines 
+	are given in doesn't matter.
+
+	The Shaders live until Clear(), references returned by Get() stay valid until then (they are never moved). Hot reload works on them like on any Shader.
+*/
+class ShaderPermutationCache {
+
+private:
+
+	struct Permutation {
+
+		std::string File;   // normalised
+		std::string DefineKey; // the sorted define set as text, to tell apart sets whose hashes collide
+		std::unique_ptr<Shader> Program;
+	};
+
+	static std::unordered_map<uint64_t, std::vector<Permutation>> s_Permutations;
+	static unsigned int s_Count;
+
+public:
+
+	// GL thread. The variant of 'filepath' with 'defines', built with 'mode' if it doesn't exist yet.
+	static Shader& Get(const std::string& filepath, const std::vector<ShaderDefine>& defines = {}, ShaderCompileMode mode = ShaderCompileMode::Blocking);
+
+	// Deletes every variant. Call before destroying the context.
+	static void Clear();
+
+	inline static unsigned int GetPermutationCount() { return s_Count; }
+};
@@ -0,0 +1,150 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#include "MappedFile.h"
+
+
+static std::vector<ShaderDefine> SortDefines(const std::vector<ShaderDefine>& defines) {
+
+	std::vector<ShaderDefine> sorted = defines;
+	std::sort(sorted.begin(), sorted.end(), [](const ShaderDefine& a, const ShaderDefine& b) { return a.Name < b.Name; });
+	return sorted;
+}
+
+// The line without leading whitespace, "  #include" and "#include" are the same directive.
+static std::string_view TrimStart(std::string_view line) {
+
+	size_t first = line.find_first_not_of(" \t");
+	return first == std::string_view::npos ? std::string_view() : line.substr(first);
+}
+
+static bool StartsWith(std::string_view str, std::string_view prefix) {
+
+	return str.substr(0, prefix.size()) == prefix;
+}
+
+// Takes the next line off the front of 'text', without its '\n'. False once 'text' is used up.
+static bool NextLine(std::string_view& text, std::string_view& line) {
+
+	if (text.empty())
+		return false;
+
+	size_t end = text.find('\n');
+	line = text.substr(0, end);
+	text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+	return true;
+}
+
+std::string ShaderPreprocessor::NormalisePath(const std::string& path) {
+
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+uint64_t ShaderPreprocessor::HashDefines(const std::vector<ShaderDefine>& defines) {
+
+	// FNV-1a, 64 bit. The separators keep { "AB", "" } and { "A", "B" } apart.
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (const ShaderDefine& define : SortDefines(defines)) {
+		for (char c : define.Name + '=' + define.Value + '\n') {
+			hash ^= (unsigned char)c;
+			hash *= 0x100000001B3ull;
+		}
+	}
+	return hash;
+}
+
+std::string ShaderPreprocessor::Process(std::string_view source, unsigned int firstLine, const std::vector<ShaderDefine>& defines, 
+	std::vector<std::string>& files) {
+
+	std::string defineBlock;
+	for (const ShaderDefine& define : SortDefines(defines))
+		defineBlock += "#define " + define.Name + (define.Value.empty() ? "" : " " + define.Value) + '\n';
+
+	std::string out;
+	out.reserve(source.size() + defineBlock.size() + 64);
+
+	// Without a #version the defines go first, that's the only place left that comes before all the code.
+	bool hasVersion = false;
+	std::string_view scan = source;
+	std::string_view line;
+	while (!hasVersion && NextLine(scan, line))
+		hasVersion = StartsWith(TrimStart(line), "#version");
+
+	unsigned int lineNumber = firstLine;
+	if (!hasVersion && !defineBlock.empty())
+		out += defineBlock + "#line " + std::to_string(firstLine) + " 0\n";
+
+	// The lines up to and including #version are copied as they are, the defines go right after. Everything else is left to Expand().
+	std::string_view rest = source;
+	bool defined = !hasVersion;
+	while (!defined && NextLine(rest, line)) {
+		out.append(line) += '\n';
+		lineNumber++;
+		if (StartsWith(TrimStart(line), "#version")) {
+			out += defineBlock + "#line " + std::to_string(lineNumber) + " 0\n";
+			defined = true;
+		}
+	}
+
+	std::vector<unsigned int> included;
+	Expand(rest, 0, lineNumber, files, included, out);
+	return out;
+}
+
+void ShaderPreprocessor::Expand(std::string_view source, unsigned int fileIndex, unsigned int firstLine, std::vector<std::string>& files, 
+	std::vector<unsigned int>& included, std::string& out) {
+
+	std::string_view line;
+	unsigned int lineNumber = firstLine;
+
+	while (NextLine(source, line)) {
+
+		const std::string_view directive = TrimStart(line);
+		if (!StartsWith(directive, "#include")) {
+			out.append(line) += '\n';
+			lineNumber++;
+			continue;
+		}
+
+		size_t open = directive.find('"');
+		size_t close = open == std::string_view::npos ? std::string_view::npos : directive.find('"', open + 1);
+		if (close == std::string_view::npos) {
+			out += "#error malformed #include, expected #include \"file\"\n";
+			lineNumber++;
+			continue;
+		}
+
+		// Relative to the directory of the file doing the including, like a C compiler does for quoted includes.
+		const std::string name(directive.substr(open + 1, close - open - 1));
+		const std::string path = NormalisePath((std::filesystem::path(files[fileIndex]).parent_path() / name).generic_string());
+
+		unsigned int index = (unsigned int)(std::find(files.begin(), files.end(), path) - files.begin());
+		if (index == files.size())
+			files.push_back(path);
+
+		if (std::find(included.begin(), included.end(), index) != included.end()) {
+			out += '\n'; // already in this stage, the empty line keeps the line numbers below it right
+			lineNumber++;
+			continue;
+		}
+		included.push_back(index);
+
+		// Mapped only while it is being expanded, the text is copied into 'out' line by line.
+		MappedFile contents(path);
+		if (!contents.IsOpen()) {
+			std::cout << "[Shader] " << files[fileIndex] << ":" << lineNumber << ": can't open include \"" << name << "\"" << std::endl;
+			out += "#error can't open include \"" + name + "\"\n";
+			lineNumber++;
+			continue;
+		}
+
+		out += "#line 1 " + std::to_string(index) + '\n';
+		Expand(contents.GetView(), index, 1, files, included, out);
+
+		lineNumber++;
+		out += "#line " + std::to_string(lineNumber) + ' ' + std::to_string(fileIndex) + '\n';
+	}
+}
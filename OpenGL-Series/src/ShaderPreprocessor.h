@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// One "#define Name Value" injected into every stage of a shader, e.g. { "USE_TEXTURE", "1" } or { "MAX_LIGHTS", "8" }. Value may be empty.
+struct ShaderDefine {
+
+	std::string Name;
+	std::string Value;
+};
+
+// Notes regarding ShaderPreprocessor
+/*
+	GLSL has no #include, so before this every shader that needed the same helper function had its own copy, and every feature variant its own file.
+	Process() runs over the source of one stage before it is handed to the driver:
+
+	- #include "file" is replaced by the contents of the file, relative to the file that includes it. A file is only included once per stage (as if it had
+	  #pragma once), which also stops include cycles. A missing file turns into an #error, so the compile fails with a readable message.
+	- The defines are inserted right after #version (GLSL doesn't allow anything before it), sorted by name so the same set always produces the same 
+	  source, and with it the same ProgramBinaryCache key.
+	- #line directives keep the driver's error messages pointing at the right place: "<source string>(<line>)" where the source string is the index of the 
+	  file in 'files' (0 = the .shader file itself) and the line is the line inside that file.
+
+	'files' collects every file that went into the program, hot reload watches all of them.
+*/
+class ShaderPreprocessor {
+
+public:
+
+	// 'source' is one stage of files[0], starting at line 'firstLine' of that file.
+	static std::string Process(std::string_view source, unsigned int firstLine, const std::vector<ShaderDefine>& defines, std::vector<std::string>& files);
+
+	// Order-independent: the same defines in any order hash the same.
+	static uint64_t HashDefines(const std::vector<ShaderDefine>& defines);
+
+	static std::string NormalisePath(const std::string& path);
+
+private:
+
+	static void Expand(std::string_view source, unsigned int fileIndex, unsigned int firstLine, std::vector<std::string>& files, 
+		std::vector<unsigned int>& included, std::string& out);
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+
+// Notes regarding std140
+/*
+	A uniform block declared 'layout(std140)' has a layout fixed by the GL spec, so a C++ struct can be uploaded into it with a single memcpy, as long as every
+	member sits at the offset the spec gives it. The rules that matter here:
+
+	- float/int/uint: 4 byte aligned, 4 bytes.
+	- vec2: 8 byte aligned. vec3/vec4: 16 byte aligned, a vec3 is only 12 bytes so a scalar may follow it in the same 16 bytes.
+	- arrays (of anything, even floats): every element is padded to 16 bytes, the array is 16 byte aligned.
+	- mat4: an array of 4 vec4 columns.
+	- whatever follows an array is 16 byte aligned automatically, since the array's size is a multiple of 16.
+
+	The types below are the C++ side of these rules, the alignment of vec2/vec4/mat4/Array makes the compiler put them at the right offset on its own. vec3 is 
+	deliberately NOT 16 byte aligned (alignas would make it 16 bytes big and push the next scalar too far), so a vec3 after a scalar needs explicit padding.
+
+	The compiler can't know what the shader expects, so each member is checked at compile time with the STD140_* macros below:
+
+		struct FrameUniforms {
+			Std140::mat4 ViewProjection;
+			Std140::vec3 CameraPosition;
+			float Time;
+		};
+		STD140_FIRST(FrameUniforms, ViewProjection);
+		STD140_NEXT(FrameUniforms, ViewProjection, CameraPosition);
+		STD140_NEXT(FrameUniforms, CameraPosition, Time);
+		STD140_END(FrameUniforms);
+
+	Every member is checked against the offset std140 gives it after the previous member, so a missing or extra padding member fails to compile.
+*/
+namespace Std140 {
+
+	struct alignas(8) vec2 { float x, y; };
+	struct vec3 { float x, y, z; };
+	struct alignas(16) vec4 { float x, y, z, w; };
+	struct alignas(16) ivec4 { int x, y, z, w; };
+	struct alignas(16) mat4 { vec4 Columns[4]; };
+
+	// T[N] with every element padded to 16 bytes, as std140 lays out arrays.
+	template<typename T, unsigned int N>
+	struct Array {
+
+		struct alignas(16) Element { T Value; };
+		Element Elements[N];
+
+		inline T& operator[](unsigned int i) { return Elements[i].Value; }
+		inline const T& operator[](unsigned int i) const { return Elements[i].Value; }
+	};
+
+	// Base alignment and size std140 gives a type. Anything not listed is rejected at compile time.
+	template<typename T> struct Rules { static_assert(sizeof(T) == 0, "Type has no std140 rules, use float/int/unsigned int or a Std140:: type"); };
+
+	template<> struct Rules<float>        { static constexpr size_t Alignment = 4;  static constexpr size_t Size = 4; };
+	template<> struct Rules<int>          { static constexpr size_t Alignment = 4;  static constexpr size_t Size = 4; };
+	template<> struct Rules<unsigned int> { static constexpr size_t Alignment = 4;  static constexpr size_t Size = 4; };
+	template<> struct Rules<vec2>         { static constexpr size_t Alignment = 8;  static constexpr size_t Size = 8; };
+	template<> struct Rules<vec3>         { static constexpr size_t Alignment = 16; static constexpr size_t Size = 12; };
+	template<> struct Rules<vec4>         { static constexpr size_t Alignment = 16; static constexpr size_t Size = 16; };
+	template<> struct Rules<ivec4>        { static constexpr size_t Alignment = 16; static constexpr size_t Size = 16; };
+	template<> struct Rules<mat4>         { static constexpr size_t Alignment = 16; static constexpr size_t Size = 64; };
+
+	template<typename T, unsigned int N>
+	struct Rules<Array<T, N>> {
+
+		static constexpr size_t Stride = (Rules<T>::Size + 15) / 16 * 16;
+		static constexpr size_t Alignment = 16;
+		static constexpr size_t Size = Stride * N;
+	};
+
+	constexpr size_t AlignUp(size_t offset, size_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+
+	// Offset std140 gives a member of type T that follows a member of type Previous placed at 'previousOffset'.
+	template<typename T, typename Previous>
+	constexpr size_t NextOffset(size_t previousOffset) { return AlignUp(previousOffset + Rules<Previous>::Size, Rules<T>::Alignment); }
+
+	// The C++ layout of Array's elements has to match the stride std140 uses, otherwise indexing it would be wrong.
+	static_assert(sizeof(Array<float, 2>) == 32, "Std140::Array element padding is broken");
+	static_assert(sizeof(Array<mat4, 2>) == 128, "Std140::Array element padding is broken");
+	static_assert(sizeof(vec3) == 12 && sizeof(vec4) == 16 && sizeof(mat4) == 64, "Std140 vector types have the wrong size");
+}
+
+#define STD140_MEMBER_TYPE(Struct, member) std::remove_cv<decltype(Struct::member)>::type
+
+#define STD140_FIRST(Struct, member) \
+	static_assert(offsetof(Struct, member) == 0, #Struct "::" #member " must be the first member")
+
+#define STD140_NEXT(Struct, previous, member) \
+	static_assert(offsetof(Struct, member) == Std140::NextOffset<STD140_MEMBER_TYPE(Struct, member), STD140_MEMBER_TYPE(Struct, previous)>(offsetof(Struct, previous)), \
+		#Struct "::" #member " is not at its std140 offset (add or remove padding before it)")
+
+// Whole-struct checks: plain data that can be memcpy'd, and a size that is a multiple of 16, so the end of the block is padded the same way on every driver.
+#define STD140_END(Struct) \
+	static_assert(std::is_standard_layout<Struct>::value && std::is_trivially_copyable<Struct>::value, #Struct " can't be uploaded with a memcpy"); \
+	static_assert(sizeof(Struct) % 16 == 0, "sizeof(" #Struct ") must be a multiple of 16, add padding at the end")
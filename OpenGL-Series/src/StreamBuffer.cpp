@@ -0,0 +1,116 @@
+#include "StreamBuffer.h"
+
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount)
+	: m_RendererID(0), m_Target(target), m_RegionSize(regionSize), m_RegionCount(regionCount), m_CurrentRegion(0), m_RegionOffset(0), m_MappedOffset(0),
+	  m_Persistent(IsPersistentMappingSupported()), m_PersistentPointer(nullptr), m_Fences(regionCount, nullptr)
+{
+	const unsigned int size = m_RegionSize * m_RegionCount;
+
+	GLCall(glGenBuffers(1, &m_RendererID));
+	Bind();
+
+	if (m_Persistent) {
+		// Storage created with glBufferStorage() is immutable, it can't be resized or orphaned, but it's the only kind that can stay mapped while drawing.
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glBufferStorage(m_Target, size, nullptr, flags));
+		GLCall(m_PersistentPointer = (unsigned char*)glMapBufferRange(m_Target, 0, size, flags));
+	}
+	else {
+		GLCall(glBufferData(m_Target, size, nullptr, GL_STREAM_DRAW));
+	}
+}
+
+StreamBuffer::~StreamBuffer() {
+
+	for (void* fence : m_Fences) {
+		if (fence) {
+			GLCall(glDeleteSync((GLsync)fence));
+		}
+	}
+
+	if (m_PersistentPointer) {
+		Bind();
+		GLCall(glUnmapBuffer(m_Target));
+	}
+
+	DeletionQueue::Release(GLObjectType::Buffer, m_RendererID);
+}
+
+StreamAllocation StreamBuffer::Map(unsigned int maxSize, unsigned int alignment) {
+
+	ASSERT(maxSize <= m_RegionSize);
+
+	unsigned int offset = (m_RegionOffset + alignment - 1) / alignment * alignment;
+	if (offset + maxSize > m_RegionSize) {
+		NextRegion();
+		offset = 0;
+	}
+
+	m_MappedOffset = m_CurrentRegion * m_RegionSize + offset;
+	m_RegionOffset = offset;
+
+	if (m_Persistent)
+		return { m_PersistentPointer + m_MappedOffset, m_MappedOffset };
+
+	// UNSYNCHRONIZED: don't wait for the GPU, nothing in flight uses this range. INVALIDATE_RANGE: the old contents don't have to be read back.
+	Bind();
+	void* pointer;
+	GLCall(pointer = glMapBufferRange(m_Target, m_MappedOffset, maxSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	return { pointer, m_MappedOffset };
+}
+
+void StreamBuffer::Unmap(unsigned int usedSize) {
+
+	m_RegionOffset += usedSize;
+
+	if (!m_Persistent) {
+		Bind();
+		GLCall(glUnmapBuffer(m_Target));
+	}
+}
+
+void StreamBuffer::EndFrame() {
+
+	NextRegion();
+}
+
+void StreamBuffer::NextRegion() {
+
+	if (m_Persistent) {
+		// Everything drawn from the current region so far comes before this fence in the command stream.
+		GLCall(m_Fences[m_CurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	}
+
+	m_CurrentRegion = (m_CurrentRegion + 1) % m_RegionCount;
+	m_RegionOffset = 0;
+
+	if (m_Persistent) {
+		GLsync fence = (GLsync)m_Fences[m_CurrentRegion];
+		if (fence) {
+			// GL_SYNC_FLUSH_COMMANDS_BIT makes sure the fence has actually been sent to the GPU, otherwise we could wait on it forever.
+			GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			while (result == GL_TIMEOUT_EXPIRED)
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms, in nanoseconds
+
+			GLCall(glDeleteSync(fence));
+			m_Fences[m_CurrentRegion] = nullptr;
+		}
+	}
+	else if (m_CurrentRegion == 0) {
+		// Wrapped around: orphan the storage, the GPU keeps the old memory for the frames still in flight.
+		Bind();
+		GLCall(glBufferData(m_Target, m_RegionSize * m_RegionCount, nullptr, GL_STREAM_DRAW));
+	}
+}
+
+void StreamBuffer::Bind() const { GLState::BindBuffer(m_Target, m_RendererID); }
+
+bool StreamBuffer::IsPersistentMappingSupported() {
+
+	return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+
+// Memory handed out by StreamBuffer::Map(). Offset is in bytes from the start of the GL buffer, it's what the draw call (or glBindBufferRange()) needs.
+struct StreamAllocation {
+
+	void* Pointer;
+	unsigned int Offset;
+};
+
+// Notes regarding StreamBuffer
+/*
+	A GL buffer for data that is rewritten every frame (batched vertices, per-draw uniforms...), split into 'regionCount' regions that are used round robin, one 
+	region per frame. 
+
+	On GL 4.4 (or ARB_buffer_storage) the buffer is created with glBufferStorage() and mapped once, PERSISTENT | COHERENT, for its whole lifetime. Writing to the
+	returned pointer writes straight into memory the GPU reads from, there's no glBufferData()/glBufferSubData() copy and no map/unmap per frame. The catch is 
+	that nothing stops us from overwriting data the GPU hasn't read yet, so when a region is done a glFenceSync() is put into the command stream after its draws,
+	and before the region is written again (regionCount frames later) we wait for that fence. With 3 regions the wait almost never actually blocks.
+
+	On GL 3.3 there is no persistent mapping. The fallback maps each allocation with glMapBufferRange(INVALIDATE_RANGE | UNSYNCHRONIZED), which is safe because
+	the regions written within a frame never overlap with data of the frames in flight, and when the buffer wraps around it is orphaned with 
+	glBufferData(nullptr), so the driver hands us fresh memory while the GPU keeps reading the old one.
+
+	Usage per frame: Map() -> write -> Unmap(bytesWritten) -> draw, as many times as needed, then EndFrame().
+*/
+class StreamBuffer {
+
+private:
+
+	unsigned int m_RendererID;
+	unsigned int m_Target;
+	unsigned int m_RegionSize;
+	unsigned int m_RegionCount;
+	unsigned int m_CurrentRegion;
+	unsigned int m_RegionOffset;  // bytes of the current region that are already used
+	unsigned int m_MappedOffset;  // offset of the allocation returned by the last Map()
+	bool m_Persistent;
+	unsigned char* m_PersistentPointer; // the whole buffer, only used when m_Persistent
+	std::vector<void*> m_Fences;  // GLsync per region, nullptr if the region has no pending fence
+
+public:
+
+	StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3);
+	~StreamBuffer();
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	// Reserves 'maxSize' bytes in the current region, starting at a multiple of 'alignment' (doesn't have to be a power of two, e.g. sizeof(QuadVertex)).
+	// If the region doesn't have room, the buffer moves on to the next region early.
+	StreamAllocation Map(unsigned int maxSize, unsigned int alignment = 4);
+	// Finishes the last Map(), only the first 'usedSize' bytes of it are kept, the rest is handed out again by the next Map().
+	void Unmap(unsigned int usedSize);
+
+	// Marks the end of the frame, the current region gets fenced and the next one is used.
+	void EndFrame();
+
+	void Bind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetTarget() const { return m_Target; }
+	inline bool IsPersistent() const { return m_Persistent; }
+
+	static bool IsPersistentMappingSupported();
+
+private:
+
+	void NextRegion();
+};
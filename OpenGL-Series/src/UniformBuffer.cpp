@@ -0,0 +1,70 @@
+#include "UniformBuffer.h"
+
+#include <unordered_map>
+
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "DirectStateAccess.h"
+
+
+UniformBuffer::UniformBuffer(const std::string& blockName, unsigned int size)
+	: m_RendererID(0), m_Size(size), m_BindingPoint(GetBindingPoint(blockName))
+{
+	m_RendererID = DirectStateAccess::CreateBuffer(GL_UNIFORM_BUFFER);
+	DirectStateAccess::BufferData(m_RendererID, GL_UNIFORM_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW);
+}
+
+UniformBuffer::~UniformBuffer() { Release(); }
+
+UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_BindingPoint(other.m_BindingPoint)
+{
+	other.m_RendererID = 0;
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept {
+
+	if (this != &other) {
+		Release();
+
+		m_RendererID = other.m_RendererID;
+		m_Size = other.m_Size;
+		m_BindingPoint = other.m_BindingPoint;
+
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
+void UniformBuffer::Release() {
+
+	DeletionQueue::Release(GLObjectType::Buffer, m_RendererID); // deleted once the GPU is done with it
+	m_RendererID = 0;
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset) {
+
+	ASSERT(offset + size <= m_Size);
+
+	DirectStateAccess::BufferSubData(m_RendererID, GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+void UniformBuffer::Bind() const {
+
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, m_BindingPoint, m_RendererID);
+}
+
+unsigned int UniformBuffer::GetBindingPoint(const std::string& blockName) {
+
+	static std::unordered_map<std::string, unsigned int> s_BindingPoints;
+
+	auto it = s_BindingPoints.find(blockName);
+	if (it != s_BindingPoints.end())
+		return it->second;
+
+	const unsigned int bindingPoint = (unsigned int)s_BindingPoints.size();
+	ASSERT(bindingPoint < 36); // GL_MAX_UNIFORM_BUFFER_BINDINGS is at least 36 on GL 3.3
+	s_BindingPoints[blockName] = bindingPoint;
+	return bindingPoint;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+
+
+// Notes regarding UniformBuffer
+/*
+	A uniform buffer object (UBO) backs a 'uniform Name { ... };' block in the shaders. Instead of one glUniform*() call (and a location lookup) per uniform, 
+	the whole block is written with one glBufferSubData() and every shader that declares the block reads from the same buffer.
+
+	Blocks are matched by name: every block name gets a fixed binding point the first time it is seen (by a Shader while linking, or by a UniformBuffer), 
+	each Shader points its blocks at those binding points right after linking, and UniformBuffer::Bind() binds the buffer to its block's point. So a 
+	"Frame" block is set once per frame and every shader using it sees the same data, whatever order shaders and buffers are created in.
+
+	The block should be declared 'layout(std140)' and the C++ struct checked with the macros in Std140.h, then Set() can copy it as is.
+*/
+class UniformBuffer {
+
+private:
+
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_BindingPoint;
+
+public:
+
+	UniformBuffer(const std::string& blockName, unsigned int size);
+	~UniformBuffer();
+
+	// Move-only, see VertexBuffer.
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+	UniformBuffer(UniformBuffer&& other) noexcept;
+	UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+	// Writes 'size' bytes at 'offset' bytes into the block.
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	// Writes the whole block from a struct laid out for std140 (see Std140.h).
+	template<typename T>
+	void Set(const T& block) {
+
+		static_assert(std::is_trivially_copyable<T>::value, "Uniform blocks are uploaded with a memcpy");
+		SetData(&block, sizeof(T));
+	}
+
+	// Binds the buffer to its block's binding point, every shader declaring the block reads from it until another buffer is bound there.
+	void Bind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetBindingPoint() const { return m_BindingPoint; }
+
+	// The binding point of the block called 'blockName', the same for every shader and buffer. Points are handed out in order, starting at 0.
+	static unsigned int GetBindingPoint(const std::string& blockName);
+
+private:
+
+	void Release();
+};
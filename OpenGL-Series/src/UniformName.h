@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// FNV-1a, 32 bit. constexpr, so the hash of a literal name can be worked out by the compiler.
+constexpr uint32_t HashUniformName(const char* name, size_t length) {
+
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// strlen() that stops at 'maxLength', constexpr so it folds away for literals like the hash does.
+constexpr size_t UniformNameLength(const char* name, size_t maxLength) {
+
+	size_t length = 0;
+	while (length < maxLength && name[length] != '\0')
+		length++;
+	return length;
+}
+
+// Notes regarding UniformName
+/*
+	The name of a uniform as Shader::SetUniform*() takes it. Passing a literal, SetUniform4f("u_Color", ...), converts it through the constexpr constructor, 
+	so the name is hashed at compile time (with optimisations on; a 'static constexpr UniformName' guarantees it in any build) and no std::string is built.
+	Shader looks the hash up in the table it filled from glGetActiveUniform() when the program linked, see Shader::GetUniformLocation().
+
+	The array constructor also takes char buffers (char name[64] filled at runtime), so it hashes up to the first NUL rather than all N - 1 characters,
+	for a literal that is the same thing. Names only known at runtime can also be passed as a std::string, they are hashed when the UniformName is made. 'Name' confirms a hash match (one
+	strcmp(), see Shader::GetUniformLocation()) and must outlive the UniformName (a literal always does).
+*/
+struct UniformName {
+
+	uint32_t Hash;
+	const char* Name;
+
+	template<size_t N>
+	constexpr UniformName(const char (&name)[N])
+		: Hash(HashUniformName(name, UniformNameLength(name, N - 1))), Name(name)
+	{}
+
+	explicit UniformName(const std::string& name)
+		: Hash(HashUniformName(name.data(), name.size())), Name(name.c_str())
+	{}
+};
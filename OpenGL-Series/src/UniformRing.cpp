@@ -0,0 +1,57 @@
+#include "UniformRing.h"
+
+#include <cstring>
+
+#include "Renderer.h"
+#include "GLState.h"
+
+
+UniformRing::UniformRing(unsigned int regionSize)
+	: m_RegionSize(regionSize), m_Alignment(0), m_UploadOffset(0)
+{
+}
+
+unsigned int UniformRing::Push(const void* data, unsigned int size) {
+
+	if (m_Alignment == 0) {
+		// Usually 256 on desktop GPUs, the spec allows anything up to 256.
+		int alignment = 0;
+		GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+		m_Alignment = alignment > 0 ? (unsigned int)alignment : 256;
+	}
+
+	const unsigned int offset = ((unsigned int)m_FrameData.size() + m_Alignment - 1) / m_Alignment * m_Alignment;
+	m_FrameData.resize(offset + size);
+	std::memcpy(m_FrameData.data() + offset, data, size);
+	return offset;
+}
+
+void UniformRing::Upload() {
+
+	if (m_FrameData.empty())
+		return;
+
+	const unsigned int size = (unsigned int)m_FrameData.size();
+	if (size > m_RegionSize || !m_Buffer) {
+		// The old buffer may still be read by frames in flight, its destructor hands it to the DeletionQueue.
+		while (m_RegionSize < size)
+			m_RegionSize *= 2;
+		m_Buffer.reset(new StreamBuffer(GL_UNIFORM_BUFFER, m_RegionSize));
+	}
+
+	// The StreamBuffer fences and rotates its regions on its own when one is full, so EndFrame() is never needed here.
+	StreamAllocation allocation = m_Buffer->Map(size, m_Alignment);
+	std::memcpy(allocation.Pointer, m_FrameData.data(), size);
+	m_Buffer->Unmap(size);
+	m_UploadOffset = allocation.Offset;
+}
+
+void UniformRing::Bind(unsigned int bindingPoint, unsigned int offset, unsigned int size) const {
+
+	GLState::BindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_Buffer->GetRendererID(), m_UploadOffset + offset, size);
+}
+
+void UniformRing::Clear() {
+
+	m_FrameData.clear(); // keeps the capacity
+}
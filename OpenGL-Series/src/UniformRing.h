@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "StreamBuffer.h"
+
+
+// Notes regarding UniformRing
+/*
+	Per-object uniforms (a transform, a colour...) change between every pair of draws. Setting them with glUniform*() means a call per value per draw, and
+	updating one shared UniformBuffer between draws makes the driver either stall or copy the buffer every time.
+
+	The ring collects the per-draw blocks of a whole frame in CPU memory, each at an offset that is a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, then 
+	Upload() copies all of them into a GL_UNIFORM_BUFFER StreamBuffer at once. Before each draw Bind() points the block's binding point at that draw's slot
+	with glBindBufferRange(), which is cheap compared to uploading.
+
+	Usage: Push() per draw while recording, Upload() once before executing the draws, Bind() per draw, Clear() when the draws have been issued.
+*/
+class UniformRing {
+
+private:
+
+	std::unique_ptr<StreamBuffer> m_Buffer; // created on the first Upload(), grown when a frame doesn't fit
+	std::vector<unsigned char> m_FrameData;
+	unsigned int m_RegionSize;
+	unsigned int m_Alignment;
+	unsigned int m_UploadOffset; // where in m_Buffer the last Upload() put m_FrameData
+
+public:
+
+	UniformRing(unsigned int regionSize = 256 * 1024);
+
+	UniformRing(const UniformRing&) = delete;
+	UniformRing& operator=(const UniformRing&) = delete;
+
+	// Copies one draw's block into the frame data, returns the offset to pass to Bind().
+	unsigned int Push(const void* data, unsigned int size);
+
+	// Copies everything pushed since the last Clear() into the GL buffer.
+	void Upload();
+	// Binds the block pushed at 'offset' to 'bindingPoint'. Only valid after Upload().
+	void Bind(unsigned int bindingPoint, unsigned int offset, unsigned int size) const;
+
+	void Clear();
+
+	inline bool IsEmpty() const { return m_FrameData.empty(); }
+};
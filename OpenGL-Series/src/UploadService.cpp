@@ -0,0 +1,190 @@
+#include "UploadService.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "StreamBuffer.h"
+
+
+UploadService::UploadService(unsigned int capacity)
+	: m_StagingID(0), m_Capacity(capacity), m_Staging(nullptr), m_Head(0), m_NextTicket(1), m_NextToCopy(1), m_Completed(0)
+{
+	if (StreamBuffer::IsPersistentMappingSupported()) {
+		// The copies read from the ring on the GPU while workers write other parts of it, so it has to stay mapped (see StreamBuffer).
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glGenBuffers(1, &m_StagingID));
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, m_StagingID);
+		GLCall(glBufferStorage(GL_COPY_READ_BUFFER, m_Capacity, nullptr, flags));
+		GLCall(m_Staging = (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, m_Capacity, flags));
+	}
+	else {
+		m_CpuStaging.resize(m_Capacity);
+		m_Staging = m_CpuStaging.data();
+	}
+}
+
+UploadService::~UploadService() {
+
+	// Uploads that were never copied are dropped. Copies already issued finish before the staging buffer is actually deleted (see DeletionQueue).
+	for (const CopyBatch& batch : m_Batches) {
+		GLCall(glDeleteSync((GLsync)batch.Fence));
+	}
+
+	if (m_StagingID) {
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, m_StagingID);
+		GLCall(glUnmapBuffer(GL_COPY_READ_BUFFER));
+		DeletionQueue::Release(GLObjectType::Buffer, m_StagingID);
+	}
+}
+
+UploadTicket UploadService::Enqueue(unsigned int destination, unsigned int destinationOffset, const void* data, unsigned int size) {
+
+	ASSERT(size > 0);
+
+	const unsigned char* bytes = (const unsigned char*)data;
+	const unsigned int maxChunkSize = m_Capacity / 4;
+	UploadTicket ticket = 0;
+
+	for (unsigned int done = 0; done < size; ) {
+		const unsigned int chunkSize = std::min(size - done, maxChunkSize);
+		unsigned int offset;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_SpaceAvailable.wait(lock, [&]() { return Reserve(chunkSize, offset); });
+
+			ticket = m_NextTicket++;
+			m_Uploads.push_back({ ticket, offset, chunkSize, destination, destinationOffset + done, false });
+		}
+
+		// The expensive part, done without holding the lock so several workers can copy at the same time.
+		std::memcpy(m_Staging + offset, bytes + done, chunkSize);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Uploads[(size_t)(ticket - m_Uploads.front().Ticket)].Staged = true;
+		}
+		done += chunkSize;
+	}
+
+	return ticket;
+}
+
+bool UploadService::IsComplete(UploadTicket ticket) {
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return ticket <= m_Completed;
+}
+
+void UploadService::Process() {
+
+	// Only the staged chunks at the start of the not-yet-copied part are taken, a chunk a worker is still writing holds back the ones after it.
+	// This keeps m_Uploads in ring order, so staging memory can be given back from the front.
+	std::vector<StagedUpload> copies;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (!m_Uploads.empty()) {
+			for (size_t i = (size_t)(m_NextToCopy - m_Uploads.front().Ticket); i < m_Uploads.size() && m_Uploads[i].Staged; i++)
+				copies.push_back(m_Uploads[i]);
+			m_NextToCopy += copies.size();
+		}
+	}
+
+	if (!copies.empty()) {
+		if (m_StagingID) {
+			GLState::BindBuffer(GL_COPY_READ_BUFFER, m_StagingID);
+			for (const StagedUpload& upload : copies) {
+				GLState::BindBuffer(GL_COPY_WRITE_BUFFER, upload.Destination);
+				GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, upload.StagingOffset, upload.DestinationOffset, upload.Size));
+			}
+		}
+		else {
+			for (const StagedUpload& upload : copies) {
+				GLState::BindBuffer(GL_COPY_WRITE_BUFFER, upload.Destination);
+				GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, upload.DestinationOffset, upload.Size, m_Staging + upload.StagingOffset));
+			}
+		}
+
+		CopyBatch batch;
+		GLCall(batch.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		batch.Last = copies.back().Ticket;
+		m_Batches.push_back(batch);
+	}
+
+	UploadTicket completed = 0;
+	while (!m_Batches.empty()) {
+		GLenum result = glClientWaitSync((GLsync)m_Batches.front().Fence, 0, 0);
+		if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+			break;
+
+		GLCall(glDeleteSync((GLsync)m_Batches.front().Fence));
+		completed = m_Batches.front().Last;
+		m_Batches.pop_front();
+	}
+
+	if (completed) {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			while (!m_Uploads.empty() && m_Uploads.front().Ticket <= completed)
+				m_Uploads.pop_front();
+			m_Completed = completed;
+		}
+		m_SpaceAvailable.notify_all();
+	}
+}
+
+void UploadService::Finish() {
+
+	UploadTicket last;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		last = m_NextTicket - 1;
+	}
+
+	Process();
+	while (!IsComplete(last)) {
+		if (!m_Batches.empty()) {
+			// GL_SYNC_FLUSH_COMMANDS_BIT makes sure the fence has actually been sent to the GPU, otherwise we could wait on it forever.
+			glClientWaitSync((GLsync)m_Batches.front().Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms, in nanoseconds
+		}
+		else {
+			std::this_thread::yield(); // a worker is still writing its chunk
+		}
+		Process();
+	}
+}
+
+bool UploadService::Reserve(unsigned int size, unsigned int& offset) {
+
+	size = (size + 3) & ~3u; // keeps every chunk 4 byte aligned
+
+	if (m_Uploads.empty()) {
+		m_Head = 0;
+		if (size > m_Capacity)
+			return false;
+	}
+	else {
+		// The oldest chunk still in use marks the end of the free space.
+		const unsigned int tail = m_Uploads.front().StagingOffset;
+
+		if (m_Head > tail) {
+			// Free space is [m_Head, capacity) and [0, tail). The gap at the end is skipped when wrapping around.
+			if (m_Head + size > m_Capacity) {
+				if (size > tail)
+					return false;
+				m_Head = 0;
+			}
+		}
+		else if (m_Head + size > tail) {
+			// Free space is [m_Head, tail), m_Head == tail means the ring is full.
+			return false;
+		}
+	}
+
+	offset = m_Head;
+	m_Head += size;
+	return true;
+}
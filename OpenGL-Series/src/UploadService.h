@@ -0,0 +1,92 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+
+// Returned by UploadService::Enqueue(). Uploads complete in the order they were enqueued, so a ticket is just a sequence number.
+typedef uint64_t UploadTicket;
+
+// Notes regarding UploadService
+/*
+	VertexBuffer/IndexBuffer upload their data in the constructor, on the GL thread. For a big mesh that means the frame stalls while the driver copies
+	megabytes of data. The UploadService moves that work off the GL thread:
+
+	- A worker thread calls Enqueue(), which copies the data into a staging ring. On GL 4.4 (or ARB_buffer_storage) the ring is a GL buffer that stays mapped
+	  (like StreamBuffer), so the worker writes straight into memory the GPU can copy from. On GL 3.3 it is plain CPU memory.
+	- Once per frame the GL thread calls Process(). For everything that has been staged it issues a glCopyBufferSubData() from the ring into the destination
+	  buffer (glBufferSubData() on 3.3), which the GPU performs asynchronously, and puts a fence after the copies.
+	- When the fence has signaled, the staging memory is reused and IsComplete() returns true for those tickets, so the mesh can be drawn.
+
+	The destination buffer has to be created on the GL thread first (e.g. VertexBuffer(size) or a BufferArena view), only its name and offset are passed to
+	the worker. It has to stay alive until the upload is complete.
+
+	Data bigger than a quarter of the ring is split into several chunks, so a big upload doesn't have to wait for the whole ring to be free. When the ring is 
+	full Enqueue() blocks until Process() has retired older uploads, so it must not be called from the GL thread itself with more data than the ring holds.
+*/
+class UploadService {
+
+private:
+
+	// One chunk of staging memory, from being reserved by a worker to the GPU having finished the copy.
+	struct StagedUpload {
+
+		UploadTicket Ticket;
+		unsigned int StagingOffset;
+		unsigned int Size;
+		unsigned int Destination;       // GL buffer name
+		unsigned int DestinationOffset; // in bytes
+		bool Staged;                    // the worker has finished writing the staging memory
+	};
+
+	// Copies issued by one Process() call and the fence that signals when they are done.
+	struct CopyBatch {
+
+		void* Fence;        // GLsync
+		UploadTicket Last;  // ticket of the last chunk copied in this batch
+	};
+
+	unsigned int m_StagingID;  // 0 when falling back to CPU memory
+	unsigned int m_Capacity;
+	unsigned char* m_Staging;  // mapped GL buffer or m_CpuStaging.data()
+	std::vector<unsigned char> m_CpuStaging;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_SpaceAvailable;
+	std::deque<StagedUpload> m_Uploads; // oldest first: copied (waiting for their fence), then not yet copied
+	unsigned int m_Head;                // where the next chunk is placed in the ring
+	UploadTicket m_NextTicket;
+	UploadTicket m_NextToCopy;
+	UploadTicket m_Completed;           // every ticket up to and including this one is complete
+
+	std::deque<CopyBatch> m_Batches;    // GL thread only
+
+public:
+
+	UploadService(unsigned int capacity = 32 * 1024 * 1024);
+	~UploadService();
+
+	UploadService(const UploadService&) = delete;
+	UploadService& operator=(const UploadService&) = delete;
+
+	// Any thread. Copies 'size' bytes of 'data' into staging memory, to be written at 'destinationOffset' bytes into the GL buffer 'destination'.
+	UploadTicket Enqueue(unsigned int destination, unsigned int destinationOffset, const void* data, unsigned int size);
+
+	// Any thread. True once the data of 'ticket' (and of every ticket before it) has arrived in its destination buffer.
+	bool IsComplete(UploadTicket ticket);
+
+	// GL thread, once per frame: issues the copies for everything staged so far and retires the copies the GPU has finished.
+	void Process();
+	// GL thread: processes until every upload enqueued so far is complete.
+	void Finish();
+
+	inline bool IsPersistent() const { return m_StagingID != 0; }
+
+private:
+
+	// Finds room for 'size' bytes in the ring, returns false if the ring is too full right now. Called with m_Mutex locked.
+	bool Reserve(unsigned int size, unsigned int& offset);
+};
@@ -1,16 +1,116 @@
 #include "VertexArray.h"
 
+#include <cstdint>
+
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "DirectStateAccess.h"
+
 
+VertexArray::VertexArray() 
+	: m_AttributeCount(0), m_BindingCount(0), m_BaseVertex(0), m_HasPerVertexBuffer(false)
+{ 
+	if (DirectStateAccess::IsEnabled()) {
+		GLCall(glCreateVertexArrays(1, &m_RendererID)); // creates the object right away, so it can be edited without ever being bound
+	}
+	else {
+		GLCall(glGenVertexArrays(1, &m_RendererID));
+	}
+}
+VertexArray::~VertexArray() { Release(); }
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_AttributeCount(other.m_AttributeCount), m_BindingCount(other.m_BindingCount), m_BaseVertex(other.m_BaseVertex), 
+	  m_HasPerVertexBuffer(other.m_HasPerVertexBuffer)
+{
+	other.m_RendererID = 0;
+	other.m_AttributeCount = 0;
+	other.m_BindingCount = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
+
+	if (this != &other) {
+		Release();
+
+		m_RendererID = other.m_RendererID;
+		m_AttributeCount = other.m_AttributeCount;
+		m_BindingCount = other.m_BindingCount;
+		m_BaseVertex = other.m_BaseVertex;
+		m_HasPerVertexBuffer = other.m_HasPerVertexBuffer;
+
+		other.m_RendererID = 0;
+		other.m_AttributeCount = 0;
+		other.m_BindingCount = 0;
+	}
+	return *this;
+}
 
-VertexArray::VertexArray() { GLCall(glGenVertexArrays(1, &m_RendererID)); }
-VertexArray::~VertexArray() { GLCall(glDeleteVertexArrays(1, &m_RendererID)); }
+void VertexArray::Release() {
+
+	if (m_RendererID == 0)
+		return;
+
+	DeletionQueue::Release(GLObjectType::VertexArray, m_RendererID); // deleted once the GPU is done with it
+	m_RendererID = 0;
+}
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout) {
 
-	Bind();
-	vb.Bind();
+	TrackBaseVertex(vb, layout.GetStride(), layout.GetInstanceDivisor());
+	BeginBuffer(vb.GetRendererID(), layout.GetStride(), layout.GetInstanceDivisor());
+	SetupAttributes(layout);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& stream, const VertexBufferLayout& layout) {
+
+	ASSERT(stream.GetTarget() == GL_ARRAY_BUFFER);
+
+	BeginBuffer(stream.GetRendererID(), layout.GetStride(), layout.GetInstanceDivisor());
+	SetupAttributes(layout);
+}
+
+void VertexArray::AddBufferAt(unsigned int firstLocation, const VertexBuffer& vb, const VertexBufferLayout& layout) {
+
+	m_AttributeCount = firstLocation;
+	AddBuffer(vb, layout);
+}
+
+void VertexArray::BeginBuffer(unsigned int buffer, unsigned int stride, unsigned int instanceDivisor) {
+
+	if (!DirectStateAccess::IsEnabled()) {
+		Bind();
+		GLState::BindBuffer(GL_ARRAY_BUFFER, buffer);
+		return;
+	}
+
+	// One binding per AddBuffer(), the divisor belongs to the binding and so applies to every attribute read from this buffer.
+	GLCall(glVertexArrayVertexBuffer(m_RendererID, m_BindingCount, buffer, 0, stride));
+	if (instanceDivisor != 0) {
+		GLCall(glVertexArrayBindingDivisor(m_RendererID, m_BindingCount, instanceDivisor));
+	}
+	m_BindingCount++;
+}
+
+void VertexArray::TrackBaseVertex(const VertexBuffer& vb, unsigned int stride, unsigned int instanceDivisor) {
+
+	// A base vertex doesn't shift per-instance attributes, so an instance buffer has to start at the beginning of its GL buffer.
+	if (instanceDivisor != 0) {
+		ASSERT(vb.GetOffset() == 0);
+		return;
+	}
+
+	// Every per-vertex attribute is shifted by the same base vertex, so all per-vertex buffers have to agree on it.
+	const int baseVertex = vb.GetBaseVertex(stride);
+	ASSERT(!m_HasPerVertexBuffer || baseVertex == m_BaseVertex);
+	m_BaseVertex = baseVertex;
+	m_HasPerVertexBuffer = true;
+}
+
+void VertexArray::SetupAttributes(const VertexBufferLayout& layout) {
+
 	const std::vector<VertexBufferElement>& elements = layout.GetElements(); // Recommended to use "const auto& elements = layout.GetElements();" instead.
 	unsigned int offset = 0;
 
@@ -18,14 +118,45 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 		
 		// For now it seems like this vector design doesn't enable for VAA to be interjected in front of a previously inserted VAA, due to the design of VertexBufferLayout.h
 		// using .pushback() method from the Vector Class. This means that the VAA's index will be in sequential order, and their index location in the VertexShader will be 
-		// dependent on their index in the "std::vector<VectorBufferElement> elements" object itself.
+		// dependent on their index in the "std::vector<VectorBufferElement> elements" object itself (plus the attributes of the buffers added before this one).
 		const VertexBufferElement& element = elements[i];
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalised, layout.GetStride(), (const void*)offset));
-		GLCall(glEnableVertexAttribArray(i));
+		SetupAttribute(m_AttributeCount + i, { element.type, element.count, element.normalised, offset }, layout.GetStride(), layout.GetInstanceDivisor());
 
-		offset += element.count * VertexBufferElement::GetSDizeOfType(element.type); 
+		offset += element.GetSize(); 
 	}
+
+	m_AttributeCount += (unsigned int)elements.size();
 }
 
-void VertexArray::Bind() const { GLCall(glBindVertexArray(m_RendererID)); }
-void VertexArray::Unbind() const { GLCall(glBindVertexArray(0)); }
+void VertexArray::SetupAttributes(const VertexAttribute* attributes, unsigned int count, unsigned int stride, unsigned int instanceDivisor) {
+
+	// The offsets were already worked out at compile time.
+	for (unsigned int i = 0; i < count; i++)
+		SetupAttribute(m_AttributeCount + i, attributes[i], stride, instanceDivisor);
+
+	m_AttributeCount += count;
+}
+
+void VertexArray::SetupAttribute(unsigned int location, const VertexAttribute& attribute, unsigned int stride, unsigned int instanceDivisor) {
+
+	if (DirectStateAccess::IsEnabled()) {
+		// The buffer, stride and divisor were set on the binding in BeginBuffer(), the attribute only describes its format and offset inside the vertex.
+		GLCall(glEnableVertexArrayAttrib(m_RendererID, location));
+		GLCall(glVertexArrayAttribFormat(m_RendererID, location, attribute.Count, attribute.Type, attribute.Normalised, attribute.Offset));
+		GLCall(glVertexArrayAttribBinding(m_RendererID, location, m_BindingCount - 1));
+		return;
+	}
+
+	GLCall(glVertexAttribPointer(location, attribute.Count, attribute.Type, attribute.Normalised, stride, (const void*)(uintptr_t)attribute.Offset));
+	GLCall(glEnableVertexAttribArray(location));
+
+	if (instanceDivisor != 0) {
+		GLCall(glVertexAttribDivisor(location, instanceDivisor));
+	}
+}
+
+void VertexArray::Bind() const { GLState::BindVertexArray(m_RendererID); }
+
+#ifndef NDEBUG
+void VertexArray::Unbind() const { GLState::BindVertexArray(0); }
+#endif
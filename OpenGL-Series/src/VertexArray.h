@@ -1,24 +1,85 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "StreamBuffer.h"
+#include "VertexBufferLayout.h"
 
 
-class VertexBufferLayout;
-
 class VertexArray {
 
 private:
 
 	unsigned int m_RendererID; 
+	unsigned int m_AttributeCount; // the location the next AddBuffer() starts at, so a per-instance buffer doesn't overwrite the per-vertex attributes
+	unsigned int m_BindingCount;   // direct state access only: the vertex buffer binding index the next AddBuffer() attaches its buffer to
+	int m_BaseVertex;              // the attributes point at the start of the GL buffer, an arena view's vertices start this many vertices into it
+	bool m_HasPerVertexBuffer;
 
 public:
 
 	VertexArray();
 	~VertexArray();
 
+	// Move-only, see VertexBuffer.
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
+	// Each call appends the layout's attributes after the ones added before, e.g. per-vertex position at location 0 and per-instance offset/colour at 1 and 2.
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& Layout);
+	// Same as above for a GL_ARRAY_BUFFER StreamBuffer. The attributes point at the start of the buffer, draws select their part of it with a base vertex.
+	void AddBuffer(const StreamBuffer& stream, const VertexBufferLayout& layout);
+	// Places the layout's attributes at 'firstLocation' onwards instead of after the previous buffer, e.g. to match the layout(location = N) of a shader
+	// or to leave a gap. Later AddBuffer() calls continue after them.
+	void AddBufferAt(unsigned int firstLocation, const VertexBuffer& vb, const VertexBufferLayout& layout);
+
+	// Same as above with a compile-time Layout, the attributes come from a constexpr array and nothing is allocated. 'instanceDivisor' works like 
+	// VertexBufferLayout::SetInstanceDivisor().
+	template<typename... Attributes>
+	void AddBuffer(const VertexBuffer& vb, const Layout<Attributes...>&, unsigned int instanceDivisor = 0) {
+
+		TrackBaseVertex(vb, Layout<Attributes...>::Stride, instanceDivisor);
+		BeginBuffer(vb.GetRendererID(), Layout<Attributes...>::Stride, instanceDivisor);
+		SetupAttributes(Layout<Attributes...>::Elements.data(), Layout<Attributes...>::Count, Layout<Attributes...>::Stride, instanceDivisor);
+	}
+
+	template<typename... Attributes>
+	void AddBuffer(const StreamBuffer& stream, const Layout<Attributes...>&, unsigned int instanceDivisor = 0) {
+
+		ASSERT(stream.GetTarget() == GL_ARRAY_BUFFER);
+
+		BeginBuffer(stream.GetRendererID(), Layout<Attributes...>::Stride, instanceDivisor);
+		SetupAttributes(Layout<Attributes...>::Elements.data(), Layout<Attributes...>::Count, Layout<Attributes...>::Stride, instanceDivisor);
+	}
 
 	void Bind() const;
+
+	// Debug builds only, same as VertexBuffer::Unbind().
+#ifdef NDEBUG
+	inline void Unbind() const {}
+#else
 	void Unbind() const;
+#endif
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	// The location the next AddBuffer() puts its first attribute at.
+	inline unsigned int GetNextLocation() const { return m_AttributeCount; }
+	// The base vertex Renderer::Draw()/Submit() draw with, non-zero when the per-vertex buffer is a view into a BufferArena. DrawRange()/DrawIndirect() 
+	// take theirs from the MeshRange instead, so one VAO can serve every mesh of a block.
+	inline int GetBaseVertex() const { return m_BaseVertex; }
+
+private:
+
+	// Makes 'buffer' the source of the attributes set up next: binds this VAO and the buffer, or with direct state access attaches the buffer to the VAO's
+	// next vertex buffer binding without binding anything.
+	void BeginBuffer(unsigned int buffer, unsigned int stride, unsigned int instanceDivisor);
+	// Remembers where the vertices of 'vb' start inside its GL buffer (see GetBaseVertex()).
+	void TrackBaseVertex(const VertexBuffer& vb, unsigned int stride, unsigned int instanceDivisor);
+	// Points the attributes of 'layout' at the buffer passed to BeginBuffer().
+	void SetupAttributes(const VertexBufferLayout& layout);
+	void SetupAttributes(const VertexAttribute* attributes, unsigned int count, unsigned int stride, unsigned int instanceDivisor);
+	void SetupAttribute(unsigned int location, const VertexAttribute& attribute, unsigned int stride, unsigned int instanceDivisor);
+	void Release();
 };
 
@@ -1,18 +1,137 @@
 #include "VertexBuffer.h"
 
+#include <iostream>
+#include <utility>
+
 #include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "DirectStateAccess.h"
+
+
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, BufferUsage usage) 
+	: m_Arena(nullptr), m_Usage(usage)
+{
+	m_RendererID = DirectStateAccess::CreateBuffer(GL_ARRAY_BUFFER);
+	DirectStateAccess::BufferData(m_RendererID, GL_ARRAY_BUFFER, size, data, GetGLUsage(m_Usage)); // creates and initialises a buffer object's data store // param - (target, size, data, usage);
+	m_View = { m_RendererID, 0, size, 0 };
+}
+
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage) 
+	: m_Arena(nullptr), m_Usage(usage)
+{
+	m_RendererID = DirectStateAccess::CreateBuffer(GL_ARRAY_BUFFER);
+	DirectStateAccess::BufferData(m_RendererID, GL_ARRAY_BUFFER, size, nullptr, GetGLUsage(m_Usage)); // nullptr only allocates the data store, nothing gets uploaded yet
+	m_View = { m_RendererID, 0, size, 0 };
+}
+
+VertexBuffer::VertexBuffer(BufferArena& arena, const void* data, unsigned int size, unsigned int stride) 
+	: m_Arena(&arena), m_View(arena.Allocate(size, stride)), m_Usage(BufferUsage::Static)
+{
+	m_RendererID = m_View.RendererID;
+	if (data)
+		m_Arena->Upload(m_View, data, size);
+}
+
+VertexBuffer::~VertexBuffer() { Release(); }
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Arena(other.m_Arena), m_View(other.m_View), m_Usage(other.m_Usage), m_Shadow(std::move(other.m_Shadow))
+{
+	other.m_RendererID = 0;
+	other.m_Arena = nullptr;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept {
+
+	if (this != &other) {
+		Release();
+
+		m_RendererID = other.m_RendererID;
+		m_Arena = other.m_Arena;
+		m_View = other.m_View;
+		m_Usage = other.m_Usage;
+		m_Shadow = std::move(other.m_Shadow);
+
+		other.m_RendererID = 0;
+		other.m_Arena = nullptr;
+	}
+	return *this;
+}
+
+void VertexBuffer::Release() {
+
+	if (m_RendererID == 0)
+		return;
+
+	// The arena owns the GL buffer, only the range is given back.
+	if (m_Arena) {
+		m_Arena->Free(m_View);
+	}
+	else {
+		DeletionQueue::Release(GLObjectType::Buffer, m_RendererID); // deleted once the GPU is done with it
+	}
+	m_RendererID = 0;
+	m_Arena = nullptr;
+}
+
+bool VertexBuffer::SetData(const void* data, unsigned int size) {
+
+	// Checked in release builds too, the bytes past the view belong to the neighbouring meshes of the arena.
+	if (m_Arena && size > m_View.Size) {
+		std::cout << "[VertexBuffer] SetData() of " << size << " bytes doesn't fit into the arena view of " << m_View.Size << " bytes, ignored." << std::endl;
+		return false;
+	}
+
+	m_Shadow.Clear(); // anything still pending is overwritten anyway
 
+	if (m_Arena) {
+		m_Arena->Upload(m_View, data, size);
+		return true;
+	}
 
-VertexBuffer::VertexBuffer(const void* data, unsigned int size) {
-	
-	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW)); // creates and initialises a buffer object's data store // param - (target, size, data, usage);
+	DirectStateAccess::BufferData(m_RendererID, GL_ARRAY_BUFFER, size, data, GetGLUsage(m_Usage));
+	m_View.Size = size;
+	return true;
 }
 
-VertexBuffer::~VertexBuffer() {	GLCall(glDeleteBuffers(1, &m_RendererID)); }
+void VertexBuffer::SetSubData(const void* data, unsigned int size, unsigned int offset) {
+
+	// Checked in release builds too, for an arena view the bytes past it belong to the neighbouring meshes.
+	if (size > m_View.Size || offset > m_View.Size - size) { // written so it can't wrap around
+		std::cout << "[VertexBuffer] SetSubData() of " << size << " bytes at offset " << offset << " is past the end of the " << m_View.Size 
+			<< " byte buffer, ignored." << std::endl;
+		return;
+	}
+	m_Shadow.Write(offset, data, size);
+}
+
+void VertexBuffer::Flush() {
+
+	if (!m_Shadow.IsDirty())
+		return;
+
+	// Every byte was rewritten: orphan instead of patching, so the upload never has to wait for draws still reading the old contents.
+	if (!m_Arena && m_Shadow.CoversWholeBuffer(m_View.Size)) {
+		DirectStateAccess::BufferData(m_RendererID, GL_ARRAY_BUFFER, m_View.Size, m_Shadow.GetData(), GetGLUsage(m_Usage));
+		m_Shadow.Clear();
+		return;
+	}
+
+	for (const DirtyRange& range : m_Shadow.GetDirtyRanges()) {
+		if (m_Arena) {
+			m_Arena->Upload(m_View, m_Shadow.GetData() + range.Begin, range.End - range.Begin, range.Begin);
+		}
+		else {
+			DirectStateAccess::BufferSubData(m_RendererID, GL_ARRAY_BUFFER, range.Begin, range.End - range.Begin, m_Shadow.GetData() + range.Begin);
+		}
+	}
+	m_Shadow.Clear();
+}
 
-void VertexBuffer::Bind() const { GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID)); }
+void VertexBuffer::Bind() const { GLState::BindBuffer(GL_ARRAY_BUFFER, m_RendererID); }
 
-void VertexBuffer::Unbind() const { GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0)); }
+#ifndef NDEBUG
+void VertexBuffer::Unbind() const { GLState::BindBuffer(GL_ARRAY_BUFFER, 0); }
+#endif
 
@@ -1,17 +1,61 @@
 #pragma once
 
+#include "BufferArena.h"
+#include "BufferShadow.h"
+
+
 class VertexBuffer {
 
 private:
 
 	unsigned int m_RendererID; // Refer to EP13-15 Notes for naming reasoning of "m_RendererID"
+	BufferArena* m_Arena;      // nullptr if the buffer owns m_RendererID, otherwise the data is the range m_View inside one of the arena's buffers
+	BufferView m_View;
+	BufferUsage m_Usage;
+	BufferShadow m_Shadow;     // pending SetSubData() writes, uploaded by Flush()
 
 public:
 
-	VertexBuffer(const void* data, unsigned int size);
+	VertexBuffer(const void* data, unsigned int size, BufferUsage usage = BufferUsage::Static);
+	// Creates a buffer of 'size' bytes without any data in it, meant to be filled with SetData()/SetSubData() later.
+	VertexBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
+	// Places the data inside a shared buffer of the arena instead of creating a buffer of its own. The range is aligned to 'stride', so GetBaseVertex() is exact.
+	VertexBuffer(BufferArena& arena, const void* data, unsigned int size, unsigned int stride);
 	~VertexBuffer();
 
+	// Move-only: a copy would delete the same GL object twice. A moved-from object owns nothing and its destructor does nothing.
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
+	// Replaces the whole contents right away. The old storage is orphaned (glBufferData()), so the GPU can keep drawing from it while the new data is written.
+	// Buffers living in an arena can't be resized: if 'size' doesn't fit into the view nothing is written and it returns false (moving the data would 
+	// invalidate every VAO and MeshRange pointing at it).
+	bool SetData(const void* data, unsigned int size);
+	// Overwrites 'size' bytes starting at 'offset' bytes. The write is only recorded, nothing reaches the GPU until Flush(). A range past the end of the 
+	// buffer is logged and ignored.
+	void SetSubData(const void* data, unsigned int size, unsigned int offset);
+	// Uploads the bytes changed by SetSubData() since the last Flush(), one glBufferSubData() per merged range. Has to be called before drawing.
+	void Flush();
+
 	void Bind() const;
+
+	// Unbinding is only there to catch code that relies on something still being bound (see EP16-EP18 notes), so it is compiled out of release builds.
+#ifdef NDEBUG
+	inline void Unbind() const {}
+#else
 	void Unbind() const;
+#endif
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetOffset() const { return m_View.Offset; } // in bytes, 0 unless the buffer lives in an arena
+	inline unsigned int GetSize() const { return m_View.Size; }
+	// The first vertex of this buffer, counted from the start of the GL buffer it lives in.
+	inline int GetBaseVertex(unsigned int stride) const { return (int)(m_View.Offset / stride); }
+
+private:
+
+	void Release();
 };
 
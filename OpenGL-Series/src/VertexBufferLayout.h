@@ -1,10 +1,28 @@
 #pragma once
 
+#include <GL/glew.h>
+
+#include <array>
 #include <vector>
-#include <stdexcept>
 
-#include "Renderer.h"
+#include "GLDebug.h"
+#include "VertexQuantizer.h"
+
+
+// How a C++ type is handed to glVertexAttribPointer(). Only the types below can be vertex attributes, anything else stops the build here.
+template<typename T>
+struct AttributeType { static_assert(sizeof(T) == 0, "Unsupported vertex attribute type, see the AttributeType specializations in VertexBufferLayout.h"); };
 
+// Normalised integer types are read by the shader as floats in [0, 1] (unsigned) or [-1, 1] (signed), the compact formats come from VertexQuantizer.
+template<> struct AttributeType<float>          { static constexpr unsigned int GLType = GL_FLOAT;          static constexpr unsigned int Components = 1; static constexpr unsigned char Normalised = GL_FALSE; };
+template<> struct AttributeType<unsigned int>   { static constexpr unsigned int GLType = GL_UNSIGNED_INT;   static constexpr unsigned int Components = 1; static constexpr unsigned char Normalised = GL_FALSE; };
+template<> struct AttributeType<unsigned char>  { static constexpr unsigned int GLType = GL_UNSIGNED_BYTE;  static constexpr unsigned int Components = 1; static constexpr unsigned char Normalised = GL_TRUE;  };
+template<> struct AttributeType<Half>           { static constexpr unsigned int GLType = GL_HALF_FLOAT;     static constexpr unsigned int Components = 1; static constexpr unsigned char Normalised = GL_FALSE; };
+template<> struct AttributeType<short>          { static constexpr unsigned int GLType = GL_SHORT;          static constexpr unsigned int Components = 1; static constexpr unsigned char Normalised = GL_TRUE;  };
+template<> struct AttributeType<unsigned short> { static constexpr unsigned int GLType = GL_UNSIGNED_SHORT; static constexpr unsigned int Components = 1; static constexpr unsigned char Normalised = GL_TRUE;  };
+template<> struct AttributeType<signed char>    { static constexpr unsigned int GLType = GL_BYTE;           static constexpr unsigned int Components = 1; static constexpr unsigned char Normalised = GL_TRUE;  };
+// One packed value holds all 4 components (x, y, z, w), GL always reads GL_INT_2_10_10_10_REV as 4 components.
+template<> struct AttributeType<PackedNormal>   { static constexpr unsigned int GLType = GL_INT_2_10_10_10_REV; static constexpr unsigned int Components = 4; static constexpr unsigned char Normalised = GL_TRUE; };
 
 struct VertexBufferElement {
 
@@ -32,11 +50,31 @@ public:
 			case GL_UNSIGNED_BYTE:
 				return sizeof(GLubyte);
 				break;
+			case GL_HALF_FLOAT:
+				return sizeof(GLhalf);
+				break;
+			case GL_SHORT:
+				return sizeof(GLshort);
+				break;
+			case GL_UNSIGNED_SHORT:
+				return sizeof(GLushort);
+				break;
+			case GL_BYTE:
+				return sizeof(GLbyte);
+				break;
 		}
 
 		ASSERT(false); // Assert due to unknown type detected. This will invoke __debugbreak;
 		return 0;
 	}
+
+	// Bytes the element takes up in a vertex. Packed formats hold all their components in one 32 bit word, so this isn't always count * size of type.
+	inline unsigned int GetSize() const {
+
+		if (type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV)
+			return 4;
+		return count * GetSDizeOfType(type);
+	}
 };
 
 class VertexBufferLayout {
@@ -45,21 +83,17 @@ private:
 
 	std::vector<VertexBufferElement> m_Elements;
 	unsigned int m_Stride;
+	unsigned int m_InstanceDivisor; // 0 = the buffer is read per vertex, N = the buffer is read once per N instances (glVertexAttribDivisor)
 
 public:
 
 	VertexBufferLayout() 
-		: m_Stride(0)
+		: m_Stride(0), m_InstanceDivisor(0)
 	{}
 
 	~VertexBufferLayout() {}
 
 
-	template<typename T>
-	void Push(unsigned int count) {
-		throw std::runtime_error("Invalid type used for VAA.");
-	}
-
 	// The push functions are to set the strides for a VAA, which will be bound to the next VBO within a VAO. // Strides = Byte offset between consecutive attribute data.
 	/*
 	Notes regarding "Emplace Initialisation"
@@ -85,27 +119,77 @@ public:
 	This technique is widely used for its simplicity and efficiency, especially when adding objects to containers without the overhead of extra copies or dynamic memory 
 	allocation (as with new).
 	*/
-	template<>
-	void Push<float>(unsigned int count) { 
-	
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE }); 
-		m_Stride += VertexBufferElement::GetSDizeOfType(GL_FLOAT) * count; // sizeof(GLfloat) * count
+	template<typename T>
+	void Push(unsigned int count) {
+		// AttributeType<T> fails to compile for types that can't be a vertex attribute, so a wrong Push<>() is a build error instead of a runtime one.
+		ASSERT(count * AttributeType<T>::Components <= 4); // a single attribute has 1 to 4 components
+		m_Elements.push_back({ AttributeType<T>::GLType, count * AttributeType<T>::Components, AttributeType<T>::Normalised });
+		m_Stride += sizeof(T) * count; // e.g. sizeof(GLfloat) * count
 	}
 
-	template<>
-	void Push<unsigned int>(unsigned int count) { 
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE }); 
-		m_Stride += VertexBufferElement::GetSDizeOfType(GL_UNSIGNED_INT) * count; // sizeof(GLuint) * count
-	}
-	
-	template<>
-	void Push<unsigned char>(unsigned int count) {
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += VertexBufferElement::GetSDizeOfType(GL_UNSIGNED_BYTE) * count; // sizeof(GLubyte) * count
-	}
+	// Turns the whole layout into a per-instance stream, e.g. an offset + colour per quad when drawing with Renderer::DrawInstanced(). Every element of the 
+	// buffer advances once per 'divisor' instances instead of once per vertex.
+	inline void SetInstanceDivisor(unsigned int divisor) { m_InstanceDivisor = divisor; }
 
 	// Getters are used by VertexArray class' AddBuffer() method. Which setups the VAA sequentially based on the order in m_Elements vector which contains VectorBufferElement. 
 	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
+	inline unsigned int GetInstanceDivisor() const { return m_InstanceDivisor; }
 };
 
+
+// One attribute of a compile-time layout, with its byte offset inside the vertex already worked out.
+struct VertexAttribute {
+
+	unsigned int Type;
+	unsigned int Count;
+	unsigned char Normalised;
+	unsigned int Offset;
+};
+
+// 'N' values of type 'T', e.g. Attr<float, 3> for a position or Attr<unsigned char, 4> for a colour.
+template<typename T, unsigned int N>
+struct Attr {
+
+	static_assert(N >= 1 && N * AttributeType<T>::Components <= 4, "A vertex attribute has 1 to 4 components");
+
+	static constexpr unsigned int Size = sizeof(T) * N;
+
+	static constexpr VertexAttribute Describe(unsigned int offset) {
+		return { AttributeType<T>::GLType, N * AttributeType<T>::Components, AttributeType<T>::Normalised, offset };
+	}
+};
+
+template<typename... Attributes>
+constexpr std::array<VertexAttribute, sizeof...(Attributes)> MakeVertexAttributes() {
+
+	std::array<VertexAttribute, sizeof...(Attributes)> attributes = {};
+	unsigned int offset = 0;
+	unsigned int i = 0;
+	((attributes[i++] = Attributes::Describe(offset), offset += Attributes::Size), ...);
+	return attributes;
+}
+
+// Notes regarding Layout
+/*
+	The compile-time counterpart of VertexBufferLayout. When the vertex format is known while writing the code (which it almost always is), 
+
+		using QuadLayout = Layout<Attr<float, 2>, Attr<float, 4>, Attr<float, 2>, Attr<float, 1>>;
+		static_assert(QuadLayout::Stride == sizeof(QuadVertex), "...");
+		va.AddBuffer(vb, QuadLayout());
+
+	describes it without a std::vector, a heap allocation or the type switch per Push(): the stride and every offset are constants the compiler works out, 
+	the attributes live in a static constexpr array, and a type that can't be an attribute doesn't compile. The stride can also be checked against the 
+	vertex struct, as above, so the two can't silently drift apart.
+*/
+template<typename... Attributes>
+struct Layout {
+
+	static_assert(sizeof...(Attributes) > 0, "A layout needs at least one attribute");
+
+	static constexpr unsigned int Count = sizeof...(Attributes);
+	static constexpr unsigned int Stride = (Attributes::Size + ...);
+	static constexpr std::array<VertexAttribute, sizeof...(Attributes)> Elements = MakeVertexAttributes<Attributes...>();
+
+	static constexpr unsigned int Offset(unsigned int index) { return Elements[index].Offset; }
+};
@@ -0,0 +1,182 @@
+#include "VertexFormatCache.h"
+
+#include <cstdint>
+
+#include "Renderer.h"
+#include "GLState.h"
+#include "DeletionQueue.h"
+#include "VertexBuffer.h"
+
+
+std::vector<VertexFormatCache::FormatEntry> VertexFormatCache::s_Formats;
+std::unordered_map<uint64_t, std::vector<unsigned int>> VertexFormatCache::s_FormatsByHash;
+
+
+// FNV-1a, 64 bit
+static inline void HashValue(uint64_t& hash, unsigned int value) {
+
+	for (unsigned int i = 0; i < 4; i++) {
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 0x100000001B3ull;
+	}
+}
+
+static bool SameAttributes(const std::vector<VertexAttribute>& a, const VertexAttribute* b, unsigned int count) {
+
+	if (a.size() != count)
+		return false;
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (a[i].Type != b[i].Type || a[i].Count != b[i].Count || a[i].Normalised != b[i].Normalised || a[i].Offset != b[i].Offset)
+			return false;
+	}
+	return true;
+}
+
+static inline uint64_t FallbackKey(unsigned int buffer, unsigned int offset) { return (uint64_t)buffer << 32 | offset; }
+
+VertexFormat VertexFormatCache::Intern(const VertexBufferLayout& layout) {
+
+	// Same offsets as VertexArray::SetupAttributes() works out for a VertexBufferLayout.
+	std::vector<VertexAttribute> attributes;
+	unsigned int offset = 0;
+	for (const VertexBufferElement& element : layout.GetElements()) {
+		attributes.push_back({ element.type, element.count, element.normalised, offset });
+		offset += element.GetSize();
+	}
+
+	return Intern(attributes.data(), (unsigned int)attributes.size(), layout.GetStride(), layout.GetInstanceDivisor());
+}
+
+VertexFormat VertexFormatCache::Intern(const VertexAttribute* attributes, unsigned int count, unsigned int stride, unsigned int instanceDivisor) {
+
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (unsigned int i = 0; i < count; i++) {
+		HashValue(hash, attributes[i].Type);
+		HashValue(hash, attributes[i].Count);
+		HashValue(hash, attributes[i].Normalised);
+		HashValue(hash, attributes[i].Offset);
+	}
+	HashValue(hash, stride);
+	HashValue(hash, instanceDivisor);
+
+	// Different layouts can share a hash, so the candidates are compared in full.
+	std::vector<unsigned int>& candidates = s_FormatsByHash[hash];
+	for (unsigned int index : candidates) {
+		const FormatEntry& format = s_Formats[index];
+		if (format.Stride == stride && format.InstanceDivisor == instanceDivisor && SameAttributes(format.Attributes, attributes, count))
+			return { index };
+	}
+
+	FormatEntry format = { std::vector<VertexAttribute>(attributes, attributes + count), stride, instanceDivisor, 0, 0, 0, {} };
+
+	if (IsSeparateFormatSupported()) {
+		GLCall(glGenVertexArrays(1, &format.VertexArray));
+		GLState::BindVertexArray(format.VertexArray);
+
+		for (unsigned int i = 0; i < count; i++) {
+			const VertexAttribute& attribute = attributes[i];
+			GLCall(glEnableVertexAttribArray(i));
+			GLCall(glVertexAttribFormat(i, attribute.Count, attribute.Type, attribute.Normalised, attribute.Offset)); // offset relative to the vertex
+			GLCall(glVertexAttribBinding(i, 0));
+		}
+
+		if (instanceDivisor != 0) {
+			GLCall(glVertexBindingDivisor(0, instanceDivisor));
+		}
+	}
+
+	const unsigned int index = (unsigned int)s_Formats.size();
+	s_Formats.push_back(std::move(format));
+	candidates.push_back(index);
+	return { index };
+}
+
+void VertexFormatCache::Bind(VertexFormat format, const VertexBuffer& vb) {
+
+	FormatEntry& entry = s_Formats[format.Index];
+
+	if (entry.VertexArray) {
+		GLState::BindVertexArray(entry.VertexArray);
+
+		// The attachment is VAO state, so it survives other VAOs being bound in between.
+		if (entry.BoundBuffer != vb.GetRendererID() || entry.BoundOffset != vb.GetOffset()) {
+			GLCall(glBindVertexBuffer(0, vb.GetRendererID(), vb.GetOffset(), entry.Stride));
+			entry.BoundBuffer = vb.GetRendererID();
+			entry.BoundOffset = vb.GetOffset();
+		}
+		return;
+	}
+
+	unsigned int& vertexArray = entry.FallbackVertexArrays[FallbackKey(vb.GetRendererID(), vb.GetOffset())];
+	if (vertexArray == 0)
+		vertexArray = CreateVertexArray(entry, vb.GetRendererID(), vb.GetOffset());
+
+	GLState::BindVertexArray(vertexArray);
+}
+
+unsigned int VertexFormatCache::CreateVertexArray(const FormatEntry& format, unsigned int buffer, unsigned int offset) {
+
+	unsigned int vertexArray;
+	GLCall(glGenVertexArrays(1, &vertexArray));
+	GLState::BindVertexArray(vertexArray);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	for (unsigned int i = 0; i < format.Attributes.size(); i++) {
+		const VertexAttribute& attribute = format.Attributes[i];
+		GLCall(glVertexAttribPointer(i, attribute.Count, attribute.Type, attribute.Normalised, format.Stride, (const void*)(uintptr_t)(offset + attribute.Offset)));
+		GLCall(glEnableVertexAttribArray(i));
+
+		if (format.InstanceDivisor != 0) {
+			GLCall(glVertexAttribDivisor(i, format.InstanceDivisor));
+		}
+	}
+
+	return vertexArray;
+}
+
+void VertexFormatCache::Clear() {
+
+	for (const FormatEntry& format : s_Formats) {
+		DeletionQueue::Release(GLObjectType::VertexArray, format.VertexArray);
+		for (const auto& fallback : format.FallbackVertexArrays)
+			DeletionQueue::Release(GLObjectType::VertexArray, fallback.second);
+	}
+
+	s_Formats.clear();
+	s_FormatsByHash.clear();
+}
+
+void VertexFormatCache::OnBufferDeleted(unsigned int buffer) {
+
+	for (FormatEntry& format : s_Formats) {
+		if (format.BoundBuffer == buffer) {
+			format.BoundBuffer = 0;
+			format.BoundOffset = 0;
+		}
+
+		// The fallback VAOs still point at the old buffer, a new buffer with the same name must not find them.
+		for (auto it = format.FallbackVertexArrays.begin(); it != format.FallbackVertexArrays.end(); ) {
+			if ((unsigned int)(it->first >> 32) == buffer) {
+				DeletionQueue::Release(GLObjectType::VertexArray, it->second);
+				it = format.FallbackVertexArrays.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+	}
+}
+
+bool VertexFormatCache::IsSeparateFormatSupported() {
+
+	return GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+}
+
+unsigned int VertexFormatCache::GetVertexArrayCount() {
+
+	unsigned int count = 0;
+	for (const FormatEntry& format : s_Formats)
+		count += (format.VertexArray ? 1 : 0) + (unsigned int)format.FallbackVertexArrays.size();
+	return count;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+
+class VertexBuffer;
+
+// A vertex layout interned by VertexFormatCache. Just an index, cheap to copy and compare, valid until VertexFormatCache::Clear().
+struct VertexFormat {
+
+	unsigned int Index;
+};
+
+// Notes regarding VertexFormatCache
+/*
+	A VertexArray ties the attribute format to one particular buffer: glVertexAttribPointer() records the format AND the buffer bound to GL_ARRAY_BUFFER at
+	that moment. So every mesh needs its own VAO, even though most meshes share one of a handful of layouts.
+
+	GL 4.3 (ARB_vertex_attrib_binding) separates the two. glVertexAttribFormat()/glVertexAttribBinding() describe the layout once and point the attributes at
+	a buffer binding point, glBindVertexBuffer() attaches a buffer (with an offset and stride) to that binding point. The cache creates one VAO per distinct
+	layout, and drawing another mesh with the same layout only changes the buffer binding, the VAO stays bound.
+
+	Layouts are interned by a hash of their attributes, stride and instance divisor, so building the same layout in two places gives the same VertexFormat.
+
+	On 3.3 contexts there is no separate format. The fallback creates one VAO per (layout, buffer, offset) combination with glVertexAttribPointer() the first
+	time it is drawn, which still gets rid of re-specifying the attributes, just with more VAOs. Those VAOs are dropped when their buffer is deleted.
+
+	All the attributes of a format come from one buffer (binding point 0) and start at location 0.
+*/
+class VertexFormatCache {
+
+private:
+
+	struct FormatEntry {
+
+		std::vector<VertexAttribute> Attributes;
+		unsigned int Stride;
+		unsigned int InstanceDivisor;
+		unsigned int VertexArray;  // 4.3 path only, the shared VAO
+		unsigned int BoundBuffer;  // 4.3 path only, what is attached to binding point 0 of the VAO
+		unsigned int BoundOffset;
+		std::unordered_map<uint64_t, unsigned int> FallbackVertexArrays; // 3.3 path only, (buffer << 32 | offset) -> VAO
+	};
+
+	static std::vector<FormatEntry> s_Formats;
+	static std::unordered_map<uint64_t, std::vector<unsigned int>> s_FormatsByHash;
+
+public:
+
+	static VertexFormat Intern(const VertexBufferLayout& layout);
+
+	template<typename... Attributes>
+	static VertexFormat Intern(const Layout<Attributes...>&, unsigned int instanceDivisor = 0) {
+		return Intern(Layout<Attributes...>::Elements.data(), Layout<Attributes...>::Count, Layout<Attributes...>::Stride, instanceDivisor);
+	}
+
+	// Binds the VAO of 'format' with 'vb' attached, ready to draw. Goes through GLState like every other bind.
+	static void Bind(VertexFormat format, const VertexBuffer& vb);
+
+	// Forgets every format and deletes their VAOs. Call before destroying the context.
+	static void Clear();
+
+	// Called by the DeletionQueue when a buffer is actually deleted, GL may hand out its name again afterwards.
+	static void OnBufferDeleted(unsigned int buffer);
+
+	static bool IsSeparateFormatSupported();
+	static unsigned int GetVertexArrayCount();
+
+private:
+
+	static VertexFormat Intern(const VertexAttribute* attributes, unsigned int count, unsigned int stride, unsigned int instanceDivisor);
+	static unsigned int CreateVertexArray(const FormatEntry& format, unsigned int buffer, unsigned int offset);
+};
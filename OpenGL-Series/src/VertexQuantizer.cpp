@@ -0,0 +1,282 @@
+#include "VertexQuantizer.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "VertexBufferLayout.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	#define QUANTIZER_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define QUANTIZER_SSE2 0
+#endif
+
+
+static inline uint32_t FloatBits(float value) { uint32_t bits; std::memcpy(&bits, &value, sizeof(bits)); return bits; }
+static inline float BitsFloat(uint32_t bits) { float value; std::memcpy(&value, &bits, sizeof(value)); return value; }
+
+static inline float Clamp(float value, float low, float high) { return value < low ? low : (value > high ? high : value); }
+
+// Notes regarding the float -> half conversion
+/*
+	A half has 1 sign, 5 exponent (bias 15) and 10 mantissa bits, a float 1, 8 (bias 127) and 23. For values in the normal half range the exponent is 
+	rebiased and the mantissa rounded from 23 to 10 bits: adding 0xFFF (+1 if the kept LSB is odd, which gives round-to-nearest-even) before shifting right
+	by 13 rounds and carries into the exponent on overflow. Values too small for a normal half are added to a "magic" float whose exponent puts the half's 
+	mantissa bits at the bottom, so the FPU does the rounding. Everything >= 65520 becomes infinity, NaNs stay NaNs.
+
+	The SSE2 version computes both paths for 4 values at once and picks the right one per lane with masks, there are no branches.
+*/
+Half VertexQuantizer::ToHalf(float value) {
+
+	const uint32_t f16Max = (127 + 16) << 23;                        // first float that rounds to infinity
+	const uint32_t f32Infinity = 255 << 23;
+	const uint32_t subnormalMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+	uint32_t bits = FloatBits(value);
+	const uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	uint16_t half;
+	if (bits >= f16Max) {
+		half = bits > f32Infinity ? 0x7E00 : 0x7C00; // NaN : infinity
+	}
+	else if (bits < (113u << 23)) {
+		half = (uint16_t)(FloatBits(BitsFloat(bits) + BitsFloat(subnormalMagic)) - subnormalMagic);
+	}
+	else {
+		const uint32_t mantissaOdd = (bits >> 13) & 1;
+		bits += ((uint32_t)(15 - 127) << 23) + 0xFFF + mantissaOdd;
+		half = (uint16_t)(bits >> 13);
+	}
+
+	return { (uint16_t)(half | (sign >> 16)) };
+}
+
+float VertexQuantizer::ToFloat(Half value) {
+
+	const uint32_t sign = (uint32_t)(value.Bits & 0x8000) << 16;
+	const uint32_t exponent = (value.Bits >> 10) & 0x1F;
+	const uint32_t mantissa = value.Bits & 0x3FF;
+
+	if (exponent == 0) // zero or subnormal: mantissa * 2^-24
+		return BitsFloat(sign | FloatBits(mantissa * 5.9604644775390625e-8f));
+	if (exponent == 31) // infinity or NaN
+		return BitsFloat(sign | 0x7F800000u | (mantissa << 13));
+	return BitsFloat(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+}
+
+#if QUANTIZER_SSE2
+static inline __m128i FloatToHalf4(__m128 value) {
+
+	const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+	const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+	const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23)); // rebias the exponent and add the rounding
+
+	const __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u)));
+	const __m128 absolute = _mm_xor_ps(value, sign);
+	const __m128i absoluteBits = _mm_castps_si128(absolute);
+
+	// Infinity or NaN (quiet NaN bit set)
+	const __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+	const __m128i special = _mm_or_si128(_mm_and_si128(isNaN, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+	const __m128i isRegular = _mm_cmpgt_epi32(f16Max, absoluteBits);
+
+	// Subnormal result
+	const __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absoluteBits);
+	const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+	// Normal result, -1 in the lanes where the kept mantissa LSB is odd
+	const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absoluteBits, 31 - 13), 31);
+	const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absoluteBits, normalBias), mantissaOdd), 13);
+
+	const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+	const __m128i result = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+	return _mm_or_si128(result, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+}
+
+// Packs 4+4 values in [0, 65535] to 8 uint16. SSE2 only has a signed saturating pack, so the values are shifted into the signed range and back.
+static inline __m128i PackUnsigned16(__m128i low, __m128i high) {
+
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(low, bias32), _mm_sub_epi32(high, bias32));
+	return _mm_add_epi16(packed, _mm_set1_epi16((short)0x8000));
+}
+
+// Clamps to [low, high], scales and rounds to nearest (the default MXCSR rounding mode).
+static inline __m128i ScaleRound4(const float* source, __m128 low, __m128 high, __m128 scale) {
+
+	return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source), low), high), scale));
+}
+#endif
+
+void VertexQuantizer::FloatToHalf(const float* source, Half* destination, size_t count) {
+
+	size_t i = 0;
+#if QUANTIZER_SSE2
+	for (; i + 8 <= count; i += 8) {
+		const __m128i low = FloatToHalf4(_mm_loadu_ps(source + i));
+		const __m128i high = FloatToHalf4(_mm_loadu_ps(source + i + 4));
+		_mm_storeu_si128((__m128i*)(destination + i), PackUnsigned16(low, high));
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = ToHalf(source[i]);
+}
+
+void VertexQuantizer::FloatToSnorm16(const float* source, int16_t* destination, size_t count) {
+
+	size_t i = 0;
+#if QUANTIZER_SSE2
+	const __m128 low = _mm_set1_ps(-1.0f), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= count; i += 8) {
+		const __m128i packed = _mm_packs_epi32(ScaleRound4(source + i, low, high, scale), ScaleRound4(source + i + 4, low, high, scale));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = (int16_t)std::lrint(Clamp(source[i], -1.0f, 1.0f) * 32767.0f);
+}
+
+void VertexQuantizer::FloatToUnorm16(const float* source, uint16_t* destination, size_t count) {
+
+	size_t i = 0;
+#if QUANTIZER_SSE2
+	const __m128 low = _mm_setzero_ps(), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(65535.0f);
+	for (; i + 8 <= count; i += 8) {
+		const __m128i packed = PackUnsigned16(ScaleRound4(source + i, low, high, scale), ScaleRound4(source + i + 4, low, high, scale));
+		_mm_storeu_si128((__m128i*)(destination + i), packed);
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = (uint16_t)std::lrint(Clamp(source[i], 0.0f, 1.0f) * 65535.0f);
+}
+
+void VertexQuantizer::FloatToSnorm8(const float* source, int8_t* destination, size_t count) {
+
+	size_t i = 0;
+#if QUANTIZER_SSE2
+	const __m128 low = _mm_set1_ps(-1.0f), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(127.0f);
+	for (; i + 16 <= count; i += 16) {
+		const __m128i a = _mm_packs_epi32(ScaleRound4(source + i, low, high, scale), ScaleRound4(source + i + 4, low, high, scale));
+		const __m128i b = _mm_packs_epi32(ScaleRound4(source + i + 8, low, high, scale), ScaleRound4(source + i + 12, low, high, scale));
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_packs_epi16(a, b));
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = (int8_t)std::lrint(Clamp(source[i], -1.0f, 1.0f) * 127.0f);
+}
+
+void VertexQuantizer::FloatToUnorm8(const float* source, uint8_t* destination, size_t count) {
+
+	size_t i = 0;
+#if QUANTIZER_SSE2
+	const __m128 low = _mm_setzero_ps(), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f);
+	for (; i + 16 <= count; i += 16) {
+		const __m128i a = _mm_packs_epi32(ScaleRound4(source + i, low, high, scale), ScaleRound4(source + i + 4, low, high, scale));
+		const __m128i b = _mm_packs_epi32(ScaleRound4(source + i + 8, low, high, scale), ScaleRound4(source + i + 12, low, high, scale));
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_packus_epi16(a, b));
+	}
+#endif
+	for (; i < count; i++)
+		destination[i] = (uint8_t)std::lrint(Clamp(source[i], 0.0f, 1.0f) * 255.0f);
+}
+
+PackedNormal VertexQuantizer::PackNormal(float x, float y, float z, float w) {
+
+	// Signed normalized, two's complement in each field. GL 4.2+ maps -511 and -512 both to -1.0, so -512 is never produced.
+	const uint32_t px = (uint32_t)std::lrint(Clamp(x, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+	const uint32_t py = (uint32_t)std::lrint(Clamp(y, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+	const uint32_t pz = (uint32_t)std::lrint(Clamp(z, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+	const uint32_t pw = (uint32_t)std::lrint(Clamp(w, -1.0f, 1.0f)) & 0x3;
+	return { px | (py << 10) | (pz << 20) | (pw << 30) };
+}
+
+unsigned int VertexQuantizer::GetFormatSize(AttributeFormat format, unsigned int components) {
+
+	switch (format) {
+		case AttributeFormat::Float:         return components * 4;
+		case AttributeFormat::Half:          return components * 2;
+		case AttributeFormat::Snorm16:       return components * 2;
+		case AttributeFormat::Unorm16:       return components * 2;
+		case AttributeFormat::Snorm8:        return components;
+		case AttributeFormat::Unorm8:        return components;
+		case AttributeFormat::Packed1010102: return 4;
+	}
+	return 0;
+}
+
+std::vector<unsigned char> VertexQuantizer::QuantizeMesh(const float* vertices, unsigned int vertexCount, const std::vector<QuantizedAttribute>& attributes, 
+	VertexBufferLayout& layout) {
+
+	unsigned int sourceStride = 0; // in floats
+	unsigned int stride = 0;       // in bytes
+	for (const QuantizedAttribute& attribute : attributes) {
+		sourceStride += attribute.Components;
+		stride += GetFormatSize(attribute.Format, attribute.Components);
+	}
+
+	std::vector<unsigned char> result((size_t)stride * vertexCount);
+	std::vector<float> gathered;
+	std::vector<unsigned char> converted;
+
+	unsigned int sourceOffset = 0;
+	unsigned int offset = 0;
+
+	// One attribute at a time: gathering it into a tight array first lets the bulk conversions run over all vertices instead of 2-4 values at a time.
+	for (const QuantizedAttribute& attribute : attributes) {
+
+		const unsigned int components = attribute.Components;
+		const unsigned int size = GetFormatSize(attribute.Format, components);
+		const size_t count = (size_t)components * vertexCount;
+
+		gathered.resize(count);
+		for (unsigned int v = 0; v < vertexCount; v++)
+			std::memcpy(&gathered[(size_t)v * components], vertices + (size_t)v * sourceStride + sourceOffset, components * sizeof(float));
+
+		converted.resize((size_t)size * vertexCount);
+		switch (attribute.Format) {
+			case AttributeFormat::Float:
+				std::memcpy(converted.data(), gathered.data(), count * sizeof(float));
+				layout.Push<float>(components);
+				break;
+			case AttributeFormat::Half:
+				FloatToHalf(gathered.data(), (Half*)converted.data(), count);
+				layout.Push<Half>(components);
+				break;
+			case AttributeFormat::Snorm16:
+				FloatToSnorm16(gathered.data(), (int16_t*)converted.data(), count);
+				layout.Push<short>(components);
+				break;
+			case AttributeFormat::Unorm16:
+				FloatToUnorm16(gathered.data(), (uint16_t*)converted.data(), count);
+				layout.Push<unsigned short>(components);
+				break;
+			case AttributeFormat::Snorm8:
+				FloatToSnorm8(gathered.data(), (int8_t*)converted.data(), count);
+				layout.Push<signed char>(components);
+				break;
+			case AttributeFormat::Unorm8:
+				FloatToUnorm8(gathered.data(), (uint8_t*)converted.data(), count);
+				layout.Push<unsigned char>(components);
+				break;
+			case AttributeFormat::Packed1010102:
+				for (unsigned int v = 0; v < vertexCount; v++) {
+					const float* n = &gathered[(size_t)v * components];
+					PackedNormal packed = PackNormal(n[0], components > 1 ? n[1] : 0.0f, components > 2 ? n[2] : 0.0f, components > 3 ? n[3] : 0.0f);
+					std::memcpy(&converted[(size_t)v * 4], &packed, 4);
+				}
+				layout.Push<PackedNormal>(1);
+				break;
+		}
+
+		for (unsigned int v = 0; v < vertexCount; v++)
+			std::memcpy(&result[(size_t)v * stride + offset], &converted[(size_t)v * size], size);
+
+		sourceOffset += components;
+		offset += size;
+	}
+
+	return result;
+}
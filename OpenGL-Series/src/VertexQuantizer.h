@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+class VertexBufferLayout;
+
+// 16 bit IEEE half float, the CPU side of a GL_HALF_FLOAT attribute. Only used as storage, convert with VertexQuantizer.
+struct Half {
+
+	uint16_t Bits;
+};
+
+// x, y, z as 10 bit and w as 2 bit signed normalized integers in one 32 bit word, the CPU side of a GL_INT_2_10_10_10_REV attribute. Enough precision
+// for normals and tangents (w can hold the bitangent sign) at a quarter of the size of 4 floats.
+struct PackedNormal {
+
+	uint32_t Bits;
+};
+
+// What a float attribute is turned into by VertexQuantizer::QuantizeMesh(), and the matching VertexBufferLayout::Push<>() type.
+enum class AttributeFormat {
+
+	Float,     // float,          4 bytes per component, unchanged
+	Half,      // Half,           2 bytes, ~3 significant digits, any range up to 65504
+	Snorm16,   // short,          2 bytes, [-1, 1]
+	Unorm16,   // unsigned short, 2 bytes, [0, 1]
+	Snorm8,    // signed char,    1 byte,  [-1, 1]
+	Unorm8,    // unsigned char,  1 byte,  [0, 1]
+	Packed1010102 // PackedNormal, 4 bytes for all 4 components (missing components are 0), [-1, 1]
+};
+
+struct QuantizedAttribute {
+
+	unsigned int Components; // floats per vertex in the source mesh
+	AttributeFormat Format;
+};
+
+// Notes regarding VertexQuantizer
+/*
+	Most vertex data doesn't need 32 bit floats: normals and tangents live in [-1, 1], UVs usually in [0, 1], colours in [0, 1] with 8 bits being plenty, and
+	positions of a reasonably sized mesh are fine as half floats. Storing them in smaller formats cuts vertex memory and the bandwidth the vertex fetch uses
+	by 2-4x, and the GPU converts them back to floats for free when the attribute is read (normalized integers map to [-1, 1]/[0, 1]).
+
+	The bulk conversions process 4 floats per iteration with SSE2 where it is available (x86/x64), with a scalar loop for the remainder and other platforms.
+	All of them round to nearest (ties to even, like the SSE2 conversion does) and clamp to the range of the target format.
+
+	Keeping attributes a multiple of 4 bytes (e.g. Half x4 for a position, Snorm16 x2 for a UV, Snorm8 x4 or Packed1010102 for a normal) avoids the slow
+	path some GPUs take for unaligned attributes.
+*/
+class VertexQuantizer {
+
+public:
+
+	static void FloatToHalf(const float* source, Half* destination, size_t count);
+	static void FloatToSnorm16(const float* source, int16_t* destination, size_t count);
+	static void FloatToUnorm16(const float* source, uint16_t* destination, size_t count);
+	static void FloatToSnorm8(const float* source, int8_t* destination, size_t count);
+	static void FloatToUnorm8(const float* source, uint8_t* destination, size_t count);
+
+	static Half ToHalf(float value);
+	static float ToFloat(Half value);
+	static PackedNormal PackNormal(float x, float y, float z, float w = 0.0f);
+
+	// Converts an interleaved float mesh, 'attributes' describes one vertex of it in order, into the interleaved compact formats. The matching layout is 
+	// pushed to 'layout', so the result can go straight into a VertexBuffer and VertexArray::AddBuffer().
+	static std::vector<unsigned char> QuantizeMesh(const float* vertices, unsigned int vertexCount, const std::vector<QuantizedAttribute>& attributes, 
+		VertexBufferLayout& layout);
+
+	static unsigned int GetFormatSize(AttributeFormat format, unsigned int components);
+};